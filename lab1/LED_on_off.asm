@@ -1,33 +1,53 @@
 ;---------------------------------------------------------------------------------------------
 ;
 ; @file LED_on_off.asm
-; @brief Implementation of function that turns on LED1 as long as S1 button is pressed and
+; @brief Implementation of functions that turn on LED1 as long as S1 button is pressed and
 ; LED2 as long as S2 button is pressed.
 ;
+; Buttons are not polled. LED_setup configures pins and enables interrupts on both
+; edges of S1 (P2.1) and S2 (P1.1), LED_S1 and LED_S2 are called from PORT2 and PORT1
+; ISRs. Every call flips P2IES/P1IES, so the next edge (press or release) is caught.
+;
+; Latency from IFG to LED pin write (MCLK cycles, CPUXv2, no other ISR running):
+;   S1: 6 (int) + 4 (call) + 4 (xor) + 3 (bit) + 2 (jnz) + 4 (bis/bic #BIT0) = 23
+;   S2: 6 (int) + 3 (bit) + 2 (jz) + 4 (call) + 4 (xor) + 3 (bit) + 2 (jnz)
+;       + 5 (bis/bic #BIT7) = 29
+; Both branches of a handler take the same number of cycles.
+;
 ; 4.2 and 4.3
 ;
 ; @date 23.04.2021
 ; @author Andrea Ciric (andreaciric23@gmail.com)
 ;
 ; @version [1.0 - 04/2021] Initial version
+; @version [1.1 - 10/2026] Edge triggered interrupts instead of polling loop
 ;
 ;---------------------------------------------------------------------------------------------
 
 			.cdecls	C,LIST,"msp430.h"
 
-			.def 	LED_on_off
+			.def 	LED_setup
+			.def 	LED_S1
+			.def 	LED_S2
 
 ;---------------------------------------------------------------------------------------------
 			.text
-LED_on_off:
+LED_setup:
 			; 4.2
-setup:		bic.b	#BIT1, &P2DIR			; P2.1 (S1) -> input
+			bic.b	#BIT1, &P2DIR			; P2.1 (S1) -> input
 			bis.b	#BIT1, &P2REN			; enable pull-up/down
 			bis.b	#BIT1, &P2OUT			; P2.1 -> pull-up
 
 			bis.b	#BIT0, &P1DIR			; P1.0 (LED1) -> output
 			bic.b	#BIT0, &P1OUT			; P1.0 -> pull-down
 
+			bis.b	#BIT1, &P2IES			; opadajuca ivica - ceka se pritisak
+			bic.b	#BIT1, &P2IFG			; inicijalno brisanje flega prekida
+			bit.b	#BIT1, &P2IN			; ako je S1 vec pritisnut
+			jnz		s1ie
+			bis.b	#BIT1, &P2IFG			; prekid se generise softverski
+s1ie		bis.b	#BIT1, &P2IE			; dozvola prekida na P2.1
+
 			; 4.3
 			bic.b	#BIT1, &P1DIR			; P1.1 (S2) -> input
 			bis.b	#BIT1, &P1REN			; enable pull-up/down
@@ -36,32 +56,59 @@ setup:		bic.b	#BIT1, &P2DIR			; P2.1 (S1) -> input
 			bis.b	#BIT7, &P4DIR			; P4.7 (LED2) -> output
 			bic.b	#BIT7, &P4OUT			; P4.7 -> pull-down
 
-;---------------------------------------------------------------------------------------------
-
-loop		bit.b	#BIT1, &P2IN			; testira bit P2.1 (taster S1)
-			jz		ledon1
-			bic.b	#BIT0, &P1OUT			; iskljucuje LED1
-
-			bit.b	#BIT1, &P1IN			; testira bit P1.1 (taster S2)
-			jz 		ledon2
-			bic.b	#BIT7, &P4OUT			; iskljucuje LED2
-			jmp		loop
-
-ledon1		bis.b	#BIT0, &P1OUT			; ukljucuje LED1
+			bis.b	#BIT1, &P1IES			; opadajuca ivica - ceka se pritisak
+			bic.b	#BIT1, &P1IFG			; inicijalno brisanje flega prekida
+			bit.b	#BIT1, &P1IN			; ako je S2 vec pritisnut
+			jnz		setend
+			bis.b	#BIT1, &P1IFG			; prekid se generise softverski
+setend		bis.b	#BIT1, &P1IE			; dozvola prekida na P1.1
 
-			; ponovo ispitujemo P1.1 da bismo pokrili i slucaj
-			; da se S2 pritisne dok je pritisnut S1
-
-			bit.b	#BIT1, &P1IN			; testira bit P1.1 (taster S2)
-			jz 		ledon2
-			bic.b	#BIT7, &P4OUT			; iskljucuje LED2
-			jmp		loop
-
-ledon2		bis.b	#BIT7, &P4OUT			; ukljucuje LED2
-			jmp		loop
-			nop
+			ret
 
+;---------------------------------------------------------------------------------------------
+; S1 (P2.1) -> LED1 (P1.0), poziva se iz PORT2 ISR
+
+LED_S1		xor.b	#BIT1, &P2IES			; sledeci prekid na suprotnoj ivici
+			bit.b	#BIT1, &P2IES			; IES = 1 => ceka se pritisak, S1 je pusten
+			jnz		led1off
+			bis.b	#BIT0, &P1OUT			; ukljucuje LED1
+			jmp		s1chk
+led1off		bic.b	#BIT0, &P1OUT			; iskljucuje LED1
+
+s1chk		bic.b	#BIT1, &P2IFG			; brisanje flega
+			; ako se S1 promenio pre brisanja flega, ivica je propustena
+			; => stanje pina mora da odgovara ivici koja se ceka
+			bit.b	#BIT1, &P2IN
+			jz		s1low
+			bit.b	#BIT1, &P2IES			; S1 pusten => IES mora biti 1
+			jnz		s1ok
+			jmp		s1miss
+s1low		bit.b	#BIT1, &P2IES			; S1 pritisnut => IES mora biti 0
+			jz		s1ok
+s1miss		bis.b	#BIT1, &P2IFG			; ponovo u prekid
+s1ok		ret
 
-			ret
+;---------------------------------------------------------------------------------------------
+; S2 (P1.1) -> LED2 (P4.7), poziva se iz PORT1 ISR
+
+LED_S2		xor.b	#BIT1, &P1IES			; sledeci prekid na suprotnoj ivici
+			bit.b	#BIT1, &P1IES			; IES = 1 => ceka se pritisak, S2 je pusten
+			jnz		led2off
+			bis.b	#BIT7, &P4OUT			; ukljucuje LED2
+			jmp		s2chk
+led2off		bic.b	#BIT7, &P4OUT			; iskljucuje LED2
+
+s2chk		bic.b	#BIT1, &P1IFG			; brisanje flega
+			; ako se S2 promenio pre brisanja flega, ivica je propustena
+			; => stanje pina mora da odgovara ivici koja se ceka
+			bit.b	#BIT1, &P1IN
+			jz		s2low
+			bit.b	#BIT1, &P1IES			; S2 pusten => IES mora biti 1
+			jnz		s2ok
+			jmp		s2miss
+s2low		bit.b	#BIT1, &P1IES			; S2 pritisnut => IES mora biti 0
+			jz		s2ok
+s2miss		bis.b	#BIT1, &P1IFG			; ponovo u prekid
+s2ok		ret
 
 			.end
@@ -0,0 +1,120 @@
+;---------------------------------------------------------------------------------------------
+;
+; @file Persist.asm
+; @brief Implementation of functions that keep value of R10 in info flash, so it is
+; shown again after reset.
+;
+; INFOD, INFOC and INFOB (0x1800 - 0x197F) are used as a ring of 192 word records,
+; INFOA is not used (LOCKA). Every record is written only once, value 0x5A00 | R10.
+; When the next record is at the start of a segment which is not empty, that segment
+; is erased first, so every segment is erased once per 192 writes.
+;
+; The latest record is the last written word followed by an erased one (0xFFFF).
+; Persist_load checks at most 192 words, ~12 MCLK cycles per word => < 2500 cycles.
+;
+; Flash erase holds the CPU for ~32ms with interrupts disabled, so Persist_save must
+; not be called from ISR. It is called from main loop, when R10 has not changed
+; for a while.
+;
+; @date 19.10.2026
+; @author Andrea Ciric (andreaciric23@gmail.com)
+;
+; @version [1.0 - 10/2026] Initial version
+;
+;---------------------------------------------------------------------------------------------
+
+			.cdecls	C,LIST,"msp430.h"
+
+			.def 	Persist_load
+			.def 	Persist_save
+
+PERSIST_START	.equ	0x1800				; INFOD
+PERSIST_END		.equ	0x1980				; INFOA se ne koristi
+SEG_SIZE		.equ	128
+PERSIST_MAGIC	.equ	0x5A00
+
+			.bss	pnext, 2, 2				; adresa sledeceg slobodnog zapisa
+			.bss	plast, 2, 2				; poslednja upisana vrednost
+
+;---------------------------------------------------------------------------------------------
+; R10 <- poslednja sacuvana vrednost, 0 ako je nema
+
+			.text
+Persist_load
+			mov.w	#PERSIST_START, R12		; tekuci zapis
+			mov.w	#PERSIST_END-2, R13		; prethodni zapis (kruzno)
+ldloop		cmp.w	#0xFFFF, 0(R12)			; slobodan zapis?
+			jne		ldnext
+			cmp.w	#0xFFFF, 0(R13)			; prethodni upisan => on je poslednji
+			jne		ldfound
+ldnext		mov.w	R12, R13
+			incd.w	R12
+			cmp.w	#PERSIST_END, R12
+			jlo		ldloop
+
+			mov.w	#PERSIST_START, R12		; nema prelaza => sve prazno ili sve puno
+			cmp.w	#0xFFFF, &PERSIST_START
+			jeq		ldnone					; sve prazno
+											; sve puno => poslednji je na kraju (R13)
+ldfound		mov.w	R12, &pnext
+			mov.w	@R13, R14
+			mov.w	R14, R15
+			and.w	#0xFF00, R15			; provera zapisa
+			cmp.w	#PERSIST_MAGIC, R15
+			jne		ldbad
+			and.w	#0x00FF, R14
+			cmp.w	#16, R14
+			jhs		ldbad
+			mov.w	R14, R10
+			mov.w	R14, &plast
+			ret
+
+ldnone		mov.w	R12, &pnext
+ldbad		clr.w	R10
+			mov.w	#0xFFFF, &plast			; prvi upis se uvek izvrsava
+			ret
+
+;---------------------------------------------------------------------------------------------
+; Upis R10 ako se razlikuje od poslednje sacuvane vrednosti, poziva se iz glavne petlje
+
+Persist_save
+			mov.w	R10, R12
+			cmp.w	R12, &plast
+			jeq		svend
+			mov.w	&pnext, R13
+			bit.w	#SEG_SIZE-1, R13		; pocetak segmenta?
+			jnz		svwrite
+			cmp.w	#0xFFFF, 0(R13)			; segment je vec obrisan
+			jeq		svwrite
+
+			dint
+			nop
+			mov.w	#FWKEY, &FCTL3			; brisanje LOCK bita
+			mov.w	#FWKEY|ERASE, &FCTL1	; brisanje segmenta
+			clr.w	0(R13)					; lazni upis pokrece brisanje, CPU ceka
+			mov.w	#FWKEY, &FCTL1
+			mov.w	#FWKEY|LOCK, &FCTL3
+			nop
+			eint
+
+svwrite		mov.w	R12, R14
+			bis.w	#PERSIST_MAGIC, R14
+			dint
+			nop
+			mov.w	#FWKEY, &FCTL3			; brisanje LOCK bita
+			mov.w	#FWKEY|WRT, &FCTL1		; upis reci
+			mov.w	R14, 0(R13)
+			mov.w	#FWKEY, &FCTL1
+			mov.w	#FWKEY|LOCK, &FCTL3
+			nop
+			eint
+
+			mov.w	R12, &plast
+			incd.w	R13						; sledeci zapis, kruzno
+			cmp.w	#PERSIST_END, R13
+			jlo		svnext
+			mov.w	#PERSIST_START, R13
+svnext		mov.w	R13, &pnext
+svend		ret
+
+			.end
@@ -5,16 +5,24 @@
 ; R10 gets incremented and LED3 changes value. Everytime S4 button is presssed value
 ; stored in register R10 gets decremented and LED4 changes value.
 ; Value stored in R10 is diplayed on a sevenseg display.
-; S3 and S4 button press is detected using interrupt.
+; S3 and S4 button press is detected using interrupt and debounced
+; with Timer A1, so no ISR busy-waits with interrupts disabled.
 ;
 ; Also, while button S1 is pressed, LED1 is turned on and while S2 is pressed,
-; LED2 is on.
+; LED2 is on. S1 and S2 are handled in PORT2 and PORT1 ISRs on both edges,
+; CPU sleeps in LPM0 between button events.
+;
+; Value of R10 is kept in info flash. Timer A2 measures 1s without change,
+; then main loop writes R10 to flash, so a burst of presses gives one write.
 ;
 ;
 ; @date 23.04.2021
 ; @author Andrea Ciric (andreaciric23@gmail.com)
 ;
 ; @version [1.0 - 04/2021] Initial version
+; @version [1.1 - 10/2026] Timer debounce instead of busy-wait in PORT1_ISR
+; @version [1.2 - 10/2026] S1/S2 -> LED1/LED2 event driven, LPM0 in main loop
+; @version [1.3 - 10/2026] R10 kept in info flash
 ;
 ;-----------------------------------------------------------------------------------
             .cdecls C,LIST,"msp430.h"       ; Include device header file
@@ -24,7 +32,21 @@
                                             ; make it known to linker.
 
             .ref	WriteLed				; 4.1 in "WriteLed.asm" file
-            .ref	LED_on_off				; 4.2 i 4.3 in "LED_on_off.asm" file
+            .ref	LED_setup				; 4.2 i 4.3 in "LED_on_off.asm" file
+            .ref	LED_S1
+            .ref	LED_S2
+            .ref	Persist_load			; u "Persist.asm" file
+            .ref	Persist_save
+;-----------------------------------------------------------------------------------
+; Debounce period
+; Timer A1 is clocked by ACLK (32768Hz), 328 cycles => ~10ms
+;-----------------------------------------------------------------------------------
+DEBOUNCE	.equ	328
+;-----------------------------------------------------------------------------------
+; Flash write delay
+; Timer A2 is clocked by ACLK (32768Hz), 32767 cycles => ~1s
+;-----------------------------------------------------------------------------------
+SAVE_DELAY	.equ	32767
 ;-----------------------------------------------------------------------------------
             .text                           ; Assemble into program memory.
             .retain                         ; Override ELF conditional linking
@@ -74,32 +96,60 @@ setup:		bis.b	#0x48, &P2DIR			; P2.3 i P2.6 -> output
 			; LED4
 			bis.b	#BIT5, &P2DIR			; P2.5 -> output
 			bic.b	#BIT5, &P2OUT			; P2.5 -> pull-down
+
+			; Timer A1 - debounce tastera S3 i S4
+			mov.w	#DEBOUNCE, &TA1CCR0		; period debounce-a
+			mov.w	#CCIE, &TA1CCTL0		; dozvola prekida za TA1CCR0
+			mov.w	#TASSEL__ACLK, &TA1CTL	; ACLK, tajmer zaustavljen
+
+			; Timer A2 - odlaganje upisa u flash
+			mov.w	#SAVE_DELAY, &TA2CCR0
+			mov.w	#CCIE, &TA2CCTL0
+			mov.w	#TASSEL__ACLK, &TA2CTL	; ACLK, tajmer zaustavljen
 			nop
 			bis.b	#GIE, SR				; dozvola svih prekida
 			nop
 ;-----------------------------------------------------------------------------------
 ; Main loop here
 ;-----------------------------------------------------------------------------------
-			mov 	#0x00, R10				; pocetna vrednost R10 na 0
+			call	#Persist_load			; pocetna vrednost R10 iz flash-a
 			call 	#WriteLed
+			call	#LED_setup				; S1 i S2 -> prekidi na obe ivice
 
-opet		call	#LED_on_off
+			; LPM0 => DCO ostaje ukljucen, pa budjenje ne produzava
+			; vreme odziva LED (iz LPM3 budjenje traje znatno duze)
+opet		bis.w	#CPUOFF|GIE, SR			; LPM0, spavanje, sav posao se radi u prekidima
+			nop
+			call	#Persist_save			; budi ga samo TA2_ISR => R10 se ne menja 1s
 			jmp 	opet
 
 			.text
-PORT1_ISR	bit.b	#0x30, &P1IFG			; provera porekla zahteva za prekid
+PORT1_ISR	bit.b	#BIT1, &P1IFG			; S2 - preslikavanje na LED2
+			jz		s34
+			call	#LED_S2
+
+s34			bit.b	#0x30, &P1IFG			; provera porekla zahteva za prekid
 			jz		exit
 
-			mov		#0xfff, R9				; cekanje da se stanje smiri nakon
-wait		dec		R9                      ; pritiska tastera
-			jnz		wait
+			bic.b	#0x30, &P1IE			; zabrana prekida S3 i S4 dok traje debounce
+			bis.w	#MC__UP|TACLR, &TA1CTL	; start tajmera, stanje se proverava u TA1_ISR
+
+exit		bic.b	#BIT4, &P1IFG			; brisanje flega koji oznacava na
+			bic.b	#BIT5, &P1IFG			; kom se pinu dogodio prekid
+			reti
+
+PORT2_ISR	call	#LED_S1					; S1 - preslikavanje na LED1
+			reti
+
+TA1_ISR		bic.w	#MC_3, &TA1CTL			; zaustavljanje tajmera
+			bis.w	#TACLR, &TA1CTL
 
 			bit.b	#BIT4, &P1IN			; da li je inc taster jos uvek pritisnut
 			jz		T4on
 			bit.b	#BIT5, &P1IN			; da li je dec taster jos uvek pritisnut
 			jz		T5on
 
-Toff		jmp		exit
+Toff		jmp		done
 T4on		xor.b	#BIT4, &P2OUT			; menja stanje LED1
 			inc		R10						; inkrementira vrednost u R10
 			;bic.b	#0xf0, R10
@@ -111,8 +161,13 @@ T5on		xor.b	#BIT5, &P2OUT			; menja stanje LED2
 			and.b	#0x0f, R10				; propusta samo niza 4 bita
 
 Write		call 	#WriteLed				; poziva funkciju WriteLed
-exit		bic.b	#BIT4, &P1IFG			; brisanje flega koji oznacava na
-			bic.b	#BIT5, &P1IFG			; kom se pinu dogodio prekid
+			bis.w	#MC__UP|TACLR, &TA2CTL	; (ponovni) start odlaganja upisa
+done		bic.b	#0x30, &P1IFG			; brisanje flegova nastalih tokom debounce-a
+			bis.b	#0x30, &P1IE			; ponovna dozvola prekida S3 i S4
+			reti
+
+TA2_ISR		bic.w	#MC_3, &TA2CTL			; zaustavljanje tajmera
+			bic.w	#CPUOFF, 0(SP)			; budjenje glavne petlje po izlasku iz prekida
 			reti
 
 ;-----------------------------------------------------------------------------------
@@ -127,6 +182,15 @@ exit		bic.b	#BIT4, &P1IFG			; brisanje flega koji oznacava na
             .sect   ".reset"                ; MSP430 RESET Vector
             .short  RESET
             
+            .sect 	".int42"				; Interrupt na pinu 2
+            .short	PORT2_ISR
+
+            .sect 	".int44"				; TIMER2_A0_VECTOR
+            .short	TA2_ISR
+
             .sect 	".int47"				; Interrupt na pinu 1
             .short	PORT1_ISR
 
+            .sect 	".int49"				; TIMER1_A0_VECTOR
+            .short	TA1_ISR
+
@@ -3,18 +3,22 @@
  * @brief Exchanging data with computer using UART communication.
  * Data received in a package (in the form of 's'XY't', X and Y being digits 0-9) is shown on the 2 7-seg displays.
  * Received data is "echoed back" to Tx.
+ * Displayed digits are kept in info flash and shown again after reset.
  *
  *
  * @date 08.05.2021.
  * @author  Andrea Ciric (andreaciric23@gmail.com)
  *
  * @version [1.0 - 05/2021] Initial version for MSP430F5529
+ * @version [1.1 - 10/2026] Display refresh can be preempted by UART RX
+ * @version [1.2 - 10/2026] Displayed digits kept in info flash
  *
  */
 
 #include <msp430.h> 
 #include <stdint.h>
 #include "writeLed.h"
+#include "persist.h"
 
 
 /**
@@ -28,6 +32,17 @@
  */
 #define TIMER_PERIOD        (163)  /* ~5ms (4.97ms)  */
 
+/**
+ * @brief RX quiet time before a flash write, in TIMER_PERIOD ticks
+ *
+ * One 's'XY't' frame takes ~2ms at ~19200 bps. After 50ms without a
+ * received char the PC is between frames, so a flash erase (~32ms, no
+ * interrupt is serviced) does not cut a frame which is being sent.
+ * A frame which starts during the erase is still lost, there is no flow
+ * control; PC sees no echo and has to send it again.
+ */
+#define RX_QUIET_TICKS      (10)
+
 #define ASCII2DIGIT(x)      (x - '0')   // macro to convert ASCII code to digit
 #define DIGIT2ASCII(x)      (x + '0')   // macro to convert digit to ASCII code
 
@@ -40,6 +55,7 @@ volatile uint8_t temp = 0;              // variable where data received in Rx is
 
 volatile uint8_t rx_cnt = 0;            // variable for counting data received
 volatile uint8_t tx_cnt = 0;            // variable for counting data sent
+volatile uint8_t rx_quiet = 0;          // ticks since the last received char
 
 volatile uint8_t digits[2];             // variable where two digits received from rx are placed
 volatile uint8_t PCK_ARRIVED = 0;       // flag that says if packet has arrived
@@ -81,7 +97,17 @@ void display(const uint16_t number)
  */
 int main(void)
 {
+    uint8_t saved[2];           // digits in the order [disp2 disp1]
+
     WDTCTL = WDTPW | WDTHOLD;   // stop watchdog timer
+
+    // restore digits shown before reset
+    if ((persist_init(saved) != 0) && (saved[0] < 10) && (saved[1] < 10))
+    {
+        disp2 = saved[0];
+        disp1 = saved[1];
+    }
+
     // sevenseg 1
     P7DIR |= BIT0;              // set P7.0 as out (SEL1)
     P7OUT |= BIT0;              // disable display 1
@@ -127,7 +153,15 @@ int main(void)
             PCK_ARRIVED = 0;
             tx_cnt = 1;
             UCA1TXBUF = 's';
+
+            saved[0] = disp2;       // written to flash once digits stop changing
+            saved[1] = disp1;
+            persist_store(saved);
         }
+
+        // flash write holds CPU, do it only between frames and while nothing is sent
+        if ((rx_quiet >= RX_QUIET_TICKS) && (rx_cnt == 0) && (tx_cnt == 0) && ((UCA1STAT & UCBUSY) == 0))
+            persist_service();
     }
 }
 
@@ -149,6 +183,7 @@ void __attribute__ ((interrupt(USCI_A1_VECTOR))) UARTISR (void)
         //display(UCA1RXBUF);               // write to 7seg
 
         temp = UCA1RXBUF;
+        rx_quiet = 0;
         if ((temp == 0x73) && (rx_cnt == 0))        // wait for 's' to be received
             rx_cnt++;
         else if ((rx_cnt >= 1) && (rx_cnt < 3))     // save next two chars
@@ -192,11 +227,17 @@ void __attribute__ ((interrupt(USCI_A1_VECTOR))) UARTISR (void)
  * @brief TA0CCR0 ISR
  *
  * Multiplex the 7seg display. Each ISR activates one digit.
+ * Also counts ticks for batching flash writes.
+ * TA1CCR0 request is cleared on entry, so only own interrupt is masked
+ * and GIE is set again => UART RX is never delayed by display refresh.
  */
 void __attribute__ ((interrupt(TIMER1_A0_VECTOR))) CCR0ISR (void)
 {
     static uint8_t current_digit = 0;
 
+    TA1CCTL0 &= ~CCIE;          // mask own interrupt
+    __enable_interrupt();       // let USCI_A1 preempt
+
     /* algorithm:
      * - turn off previous display (SEL signal)
      * - set a..g for current display
@@ -216,5 +257,11 @@ void __attribute__ ((interrupt(TIMER1_A0_VECTOR))) CCR0ISR (void)
     }
     current_digit = (current_digit + 1) & 0x01;
 
+    persist_tick();
+    if (rx_quiet < RX_QUIET_TICKS)
+        rx_quiet++;
+
+    __disable_interrupt();
+    TA1CCTL0 |= CCIE;           // unmask own interrupt, reti restores GIE
     return;
 }
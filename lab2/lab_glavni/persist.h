@@ -0,0 +1,59 @@
+/**
+ * @file persist.h
+ * @brief Wear levelled storage of runtime state in info flash
+ *
+ * State is kept as append-only records of PERSIST_DATA_SIZE bytes in
+ * INFOD, INFOC and INFOB (0x1800 - 0x197F). INFOA is not used, it is
+ * protected by LOCKA. Only one segment is active. When it is full the
+ * next one is erased, the record is written there and then the old
+ * segment is erased, so every segment is erased once per 96 records.
+ *
+ * persist_store() only copies the state into RAM. It is written by
+ * persist_service() from main loop, once the state has not changed for
+ * PERSIST_DELAY ticks, so flash program (~85us) and erase (~32ms)
+ * never run inside an ISR. CPU is held during flash operations and
+ * no interrupt is serviced, so persist_service() should be called only
+ * while UART is idle. Without flow control a char received during an
+ * erase is lost, main.c waits for a quiet RX gap to make it unlikely.
+ *
+ * @date 19.10.2026.
+ * @author  Andrea Ciric (andreaciric23@gmail.com)
+ *
+ * @version [1.0 - 10/2026] Initial version for MSP430F5529
+ *
+ */
+
+#ifndef PERSIST_H_
+#define PERSIST_H_
+
+#include <stdint.h>
+
+#define PERSIST_DATA_SIZE   (2)     // bytes of state in one record, must be even
+#define PERSIST_DELAY       (200)   // ticks without change before write (1s at 5ms tick)
+
+/**
+ * @brief Find the latest record
+ * @param data - PERSIST_DATA_SIZE bytes where the record is copied
+ * @return 1 if record was found, 0 if flash holds no valid record
+ *
+ * At most 96 records are checked, so restore time is bounded.
+ */
+extern uint8_t persist_init(void *data);
+
+/**
+ * @brief Remember new state, it is written later by persist_service()
+ * @param data - PERSIST_DATA_SIZE bytes of state
+ */
+extern void persist_store(const void *data);
+
+/**
+ * @brief Count ticks without change, called from the tick ISR
+ */
+extern void persist_tick(void);
+
+/**
+ * @brief Write pending state to flash if it has been stable long enough
+ */
+extern void persist_service(void);
+
+#endif /* PERSIST_H_ */
@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+"""
+@file cmd_bench.py
+@brief Host side of the lab_main binary command protocol (see lab_main/cmd.h)
+
+Measures command round trip latency with ping (one command in flight)
+and the commands/second limit (several commands in flight), then reads
+the target side dispatcher stats, a lower bound of the UART RX latency
+from the interrupt stats and the last capture result.
+
+usage: cmd_bench.py PORT [-n COUNT] [-w WINDOW] [-p PAYLOAD]
+
+@date 19.10.2026.
+@author  Andrea Ciric (andreaciric23@gmail.com)
+
+@version [1.0 - 10/2026] Initial version
+"""
+
+import argparse
+import struct
+import time
+
+import serial
+
+SYNC_REQ = 0xA5
+SYNC_REPLY = 0x5A
+
+OP_PING = 0x00
+OP_UART_STATS = 0x0B
+OP_IRQ_STATS = 0x0C
+OP_CMD_STATS = 0x0D
+OP_CLEAR_STATS = 0x0E
+OP_CAPTURE = 0x10
+
+CAP_DUTY_UNKNOWN = 0xFFFF    # capture duty when the start level was not known
+
+SMCLK = 7995392             # TA2 clock, target latency is in SMCLK cycles
+RX_SIZE = 32                # target RX buffer, frames in flight must fit
+IRQ_SOURCES = ["uart", "adc12", "tick", "button"]   # IRQ_SRC_x order
+
+
+def xor(data):
+    s = 0
+    for b in data:
+        s ^= b
+    return s
+
+
+def frame(op, arg=b""):
+    body = bytes([op, len(arg)]) + arg
+    return bytes([SYNC_REQ]) + body + bytes([xor(body)])
+
+
+def read_reply(port):
+    """Return (opcode, status, data) of the next reply frame."""
+    while True:
+        b = port.read(1)
+        if not b:
+            raise TimeoutError("no reply")
+        if b[0] == SYNC_REPLY:
+            break
+    op, status, length = port.read(3)
+    data = port.read(length)
+    chk = port.read(1)[0]
+    if xor(bytes([op, status, length]) + data) != chk:
+        raise ValueError("bad reply checksum")
+    return op, status, data
+
+
+def call(port, op, arg=b""):
+    port.write(frame(op, arg))
+    rop, status, data = read_reply(port)
+    if rop != op or status != 0:
+        raise RuntimeError("op 0x%02x: status %d" % (rop, status))
+    return data
+
+
+def latency(port, count, payload):
+    arg = bytes(range(payload))
+    times = []
+    for _ in range(count):
+        t = time.perf_counter()
+        if call(port, OP_PING, arg) != arg:
+            raise ValueError("ping echo mismatch")
+        times.append(time.perf_counter() - t)
+    times.sort()
+    print("round trip (%d B ping, %d runs): min %.2f ms, median %.2f ms, max %.2f ms"
+          % (payload, count, times[0] * 1e3, times[len(times) // 2] * 1e3, times[-1] * 1e3))
+
+
+def throughput(port, count, window, payload):
+    req = frame(OP_PING, bytes(range(payload)))
+    window = max(1, min(window, RX_SIZE // len(req)))
+    sent = done = 0
+    t = time.perf_counter()
+    while done < count:
+        while sent < count and sent - done < window:
+            port.write(req)
+            sent += 1
+        read_reply(port)
+        done += 1
+    t = time.perf_counter() - t
+    print("throughput (%d B ping, %d in flight): %.1f commands/s"
+          % (payload, window, count / t))
+
+
+def rx_latency(port, baud):
+    """RX latency lower bound: longest blocked time of another policy source plus UART ISR.
+
+    PWM boundary, TA2 overflow and CTS ISRs are outside the policy and
+    main loop critical sections are not measured, any of them can add to
+    this, see lab_main/irq.h.
+    """
+    s = struct.unpack("<%dH" % (len(IRQ_SOURCES) + 1), call(port, OP_IRQ_STATS))
+    blocked, preempted = s[:-1], s[-1]
+    print("target: blocked max " + ", ".join("%s %d" % (n, b) for n, b in zip(IRQ_SOURCES, blocked))
+          + " cycles, %d UART preemptions" % preempted)
+    bound = max(blocked[1:]) + blocked[0]
+    char = 10.0 / baud          # start, 8 data, stop
+    print("target: RX latency lower bound (policy ISRs only) %d cycles (%.1f us), "
+          "character time %.1f us%s"
+          % (bound, bound * 1e6 / SMCLK, char * 1e6,
+             "" if bound < char * SMCLK else "  OVERRUN POSSIBLE"))
+
+
+def target_stats(port):
+    frames, chk, length, opcode, timeout, deferred, last, worst = \
+        struct.unpack("<8H", call(port, OP_CMD_STATS))
+    print("target: %d frames, errors chk/len/op/timeout %d/%d/%d/%d, %d deferred"
+          % (frames, chk, length, opcode, timeout, deferred))
+    print("target: dispatch latency last %d cycles (%.1f us), max %d cycles (%.1f us)"
+          % (last, last * 1e6 / SMCLK, worst, worst * 1e6 / SMCLK))
+    uart = struct.unpack("<8HBB", call(port, OP_UART_STATS))
+    print("target: uart rx %d, overrun %d, rx dropped %d, tx dropped %d"
+          % (uart[0], uart[1], uart[5], uart[6]))
+    period, freq, duty, periods, blocks, missed = \
+        struct.unpack("<2L4H", call(port, OP_CAPTURE))
+    duty = "unknown" if duty == CAP_DUTY_UNKNOWN else "%.1f%%" % (duty / 10.0)
+    print("target: P2.5 %d Hz, period %d cycles, duty %s (%d periods, block %d, %d missed)"
+          % (freq, period, duty, periods, blocks, missed))
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("port")
+    ap.add_argument("-b", "--baud", type=int, default=9600)
+    ap.add_argument("-n", "--count", type=int, default=200)
+    ap.add_argument("-w", "--window", type=int, default=4)
+    ap.add_argument("-p", "--payload", type=int, default=0)
+    a = ap.parse_args()
+
+    with serial.Serial(a.port, a.baud, timeout=1) as port:
+        port.reset_input_buffer()
+        call(port, OP_CLEAR_STATS)
+        latency(port, a.count, a.payload)
+        throughput(port, a.count, a.window, a.payload)
+        target_stats(port)
+        rx_latency(port, a.baud)
+
+
+if __name__ == "__main__":
+    main()
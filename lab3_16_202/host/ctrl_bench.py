@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+"""
+@file ctrl_bench.py
+@brief Maximum stable rate of the lab_main control loop (see lab_main/ctrl.h)
+
+Runs the PID loop in sync with PWM (ACQ_TRIG_TA0) and shortens the PWM
+period step by step. At every rate the target stats are cleared, the
+loop runs for a while and then iterations, overruns, jitter and step
+cycles are read back. Elapsed time is measured on the target, so the
+UART and USB delays of the host do not count. A rate is stable when
+the loop ran on every PWM period, give or take the one in flight at
+clear and read, and no output missed its boundary. The highest rate which is
+stable, together with all slower ones, is reported.
+
+Flash writes on the target are suspended for the whole run, a write
+(~32ms with an erase) inside a measurement would show up as overruns.
+PWM period, duty, trigger and the controller mode, setpoint and gains
+are read first and restored at the end.
+
+usage: ctrl_bench.py PORT [-s SETPOINT] [-t SECONDS] [--kp KP --ki KI --kd KD]
+
+@date 19.10.2026.
+@author  Andrea Ciric (andreaciric23@gmail.com)
+
+@version [1.0 - 10/2026] Initial version
+"""
+
+import argparse
+import struct
+import time
+
+import serial
+
+from cmd_bench import call, SMCLK, OP_CLEAR_STATS
+
+OP_PWM_DUTY = 0x02
+OP_PWM_PERIOD = 0x03
+OP_TRIGGER = 0x06
+OP_CTRL_MODE = 0x11
+OP_CTRL_PARAMS = 0x12
+OP_CTRL_STATS = 0x13
+OP_PERSIST = 0x14
+
+CTRL_OPEN = 0
+CTRL_PID = 1
+ACLK = 32768                # PWM clock, one loop iteration per PWM period
+PERIODS = [32768, 4096, 1024, 256, 128, 64, 32, 16, 8, 4, 3]  # >= ACQ_TA0_PERIOD_MIN
+
+
+def save_state(port):
+    """Read the settings the benchmark changes."""
+    return {op: call(port, op) for op in
+            (OP_PWM_PERIOD, OP_PWM_DUTY, OP_TRIGGER, OP_CTRL_MODE, OP_CTRL_PARAMS)}
+
+
+def restore_state(port, state):
+    """Put back settings from save_state()."""
+    call(port, OP_CTRL_MODE, bytes([CTRL_OPEN]))    # PID would refuse trigger change
+    call(port, OP_TRIGGER, state[OP_TRIGGER])       # before period, TA0 trigger limits it
+    call(port, OP_PWM_PERIOD, state[OP_PWM_PERIOD])
+    call(port, OP_CTRL_PARAMS, state[OP_CTRL_PARAMS])
+    call(port, OP_CTRL_MODE, state[OP_CTRL_MODE])
+    call(port, OP_PWM_DUTY, state[OP_PWM_DUTY])     # after mode, PID gives duty back to pot
+
+
+def measure(port, period, seconds):
+    """Run the loop at one PWM period, return stats and expected iterations."""
+    call(port, OP_PWM_PERIOD, struct.pack("<H", period))
+    time.sleep(max(0.05, 4.0 * period / ACLK))     # settle, a few periods
+    call(port, OP_CLEAR_STATS)
+    # at least 10 periods, iteration counter is 16 bit
+    time.sleep(max(seconds, 10.0 * period / ACLK))
+    stats = struct.unpack("<6HL2HL", call(port, OP_CTRL_STATS))
+    elapsed = stats[-1]                             # SMCLK cycles, on the target
+    return stats, elapsed * ACLK / (SMCLK * period)
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("port")
+    ap.add_argument("-b", "--baud", type=int, default=9600)
+    ap.add_argument("-s", "--setpoint", type=int, default=2048)
+    ap.add_argument("-t", "--time", type=float, default=1.0)
+    ap.add_argument("--kp", type=int, default=0x0800)
+    ap.add_argument("--ki", type=int, default=0x0200)
+    ap.add_argument("--kd", type=int, default=0)
+    a = ap.parse_args()
+
+    best = None
+    with serial.Serial(a.port, a.baud, timeout=1) as port:
+        port.reset_input_buffer()
+        state = save_state(port)
+        call(port, OP_PERSIST, bytes([1]))
+        try:
+            call(port, OP_CTRL_PARAMS, struct.pack("<4H", a.setpoint, a.kp, a.ki, a.kd))
+            call(port, OP_CTRL_MODE, bytes([CTRL_PID]))
+
+            print("   rate Hz  iter/expected  overruns  sat  cycles max  jitter  budget  sample")
+            for period in PERIODS:
+                (it, over, sat, last, worst, jitter, interval, sample, out, elapsed), expected = \
+                    measure(port, period, a.time)
+                expected = int(expected)            # whole periods in the window
+                stable = over == 0 and it >= expected - 1
+                budget = period * SMCLK // ACLK     # SMCLK cycles per iteration
+                print("%10.1f  %6d/%-6d  %8d  %4d  %10d  %6d  %6d  %6d  %s"
+                      % (ACLK / period, it, expected, over, sat, worst, jitter,
+                         budget, sample, "ok" if stable else "UNSTABLE"))
+                if not stable:
+                    break
+                best = (period, worst)
+        finally:
+            restore_state(port, state)
+            call(port, OP_PERSIST, bytes([0]))
+
+    if best is None:
+        print("no stable rate")
+        return
+    period, worst = best
+    print("max stable loop rate: %.1f Hz (PWM period %d ACLK cycles)" % (ACLK / period, period))
+    if worst:
+        print("controller step alone: %d cycles max, %.1f us, bound %.0f Hz"
+              % (worst, worst * 1e6 / SMCLK, SMCLK / worst))
+
+
+if __name__ == "__main__":
+    main()
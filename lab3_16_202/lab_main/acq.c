@@ -0,0 +1,269 @@
+/**
+ * @file acq.c
+ * @brief ADC12 acquisition front end
+ *
+ * Trigger source is changed through ADC12SHS bits, which can be written
+ * only while ADC12ENC = 0. ADC12 always works in repeat single channel
+ * mode (ADC12CONSEQ_2) with ADC12MSC = 0, so every rising edge of the
+ * sample/hold input (timer OUT or ADC12SC) gives exactly one conversion.
+ *
+ * @date 19.10.2026.
+ * @author  Andrea Ciric (andreaciric23@gmail.com)
+ *
+ * @version [1.0 - 10/2026] Initial version for MSP430F5529
+ *
+ */
+
+#include <msp430.h>
+#include <stdint.h>
+#include "acq.h"
+#include "irq.h"
+
+#define BUTTON_PIN      (BIT4)      // P1.4
+#define DEBOUNCE_TICKS  (2)         // 2 x 5ms tick
+
+static volatile uint8_t trigger = ACQ_TRIG_SOFTWARE;
+static volatile uint8_t debounce = 0;       // ticks left until button is checked
+
+static volatile uint16_t buf[ACQ_BUF_SIZE];
+static volatile uint8_t head = 0;           // next write position
+static volatile uint8_t count = 0;          // valid samples in buffer
+static volatile uint8_t state = ACQ_IDLE;
+static volatile uint8_t evt;
+static volatile uint16_t threshold;
+static volatile uint16_t prev;              // previous sample, for threshold crossing
+static volatile uint8_t pre_len, post_len;  // requested burst window
+static volatile uint8_t pre_cnt;            // pre-trigger samples available at the event
+static volatile uint8_t post_left;          // post-trigger samples still to capture
+
+/**
+ * @brief Freeze pre-trigger part of the buffer
+ * @param included - 1 if the last stored sample belongs to post-trigger part
+ *
+ * Must be called from ISR or with interrupts disabled.
+ */
+static void trigger_burst(uint8_t included)
+{
+    pre_cnt = count - included;
+    if (pre_cnt > pre_len)
+        pre_cnt = pre_len;
+    post_left = post_len - included;
+    state = (post_left == 0) ? ACQ_DONE : ACQ_TRIGGERED;
+}
+
+void acq_init(uint8_t trig)
+{
+    // configure button on P1.4
+    P1REN |= BUTTON_PIN;        // enable pull up/down
+    P1OUT |= BUTTON_PIN;        // set pull up
+    P1DIR &= ~BUTTON_PIN;       // configure P1.4 as in
+    P1IES |= BUTTON_PIN;        // interrupt on falling edge
+    P1IFG &= ~BUTTON_PIN;       // clear flag
+    P1IE  |= BUTTON_PIN;        // enable interrupt
+
+    /* REF module */
+    REFCTL0 &= ~REFMSTR;        // ref system controlled by legacy control bits inside ADC12_A
+
+    /* ADC12_A channel A0 init */
+    P6SEL |= BIT0;              // set pin P6.0 as alternate function - A0 analog
+                                // this is pot2 potentiometer
+    ADC12CTL0 &= ~ADC12ENC;     // disable ADC before configuring
+    /* 32 cycles for sampling, ref voltage is set by ADC12_A, ADC ON */
+    ADC12CTL0 |= ADC12SHT0_3 + ADC12REF2_5V + ADC12ON;
+    ADC12CTL1 |= ADC12CSTARTADD_0 + ADC12SHP + ADC12SSEL_0 + ADC12CONSEQ_2; // start address ADC12MEM0
+                                                                            // repeat single channel, MODCLK clock
+                                                                            // SAMPCON sourced from the sampling timer
+    ADC12CTL2 |= ADC12RES_2;    // 12 bit conversion result
+    ADC12MCTL0 |= ADC12INCH_0;  // reference AVCC and AVSS, channel A0
+
+    ADC12IE |= ADC12IE0;        // enable interrupt request for the ADC12IFG0 bit
+
+    /* initialize Timer B0 for ADC12 trigger */
+    // CBOUT CCR0 TB0 -> ADC12SHS2 this is internal, ports and pins not used (P5.6)
+    TB0CCTL0 |= OUTMOD_4;       // toggle mode
+    acq_set_period(CONV_PERIOD);
+    TB0CTL |= TBSSEL__ACLK + ID__1 + MC__UP;
+
+    /* TA0.1 -> ADC12SHS1, OUT is set on TA0CCR0 => rising edge at start of every PWM period */
+    TA0CCR1 = 1;
+    TA0CCTL1 = OUTMOD_7;        // outmode is Reset/Set
+
+    acq_set_trigger(trig);
+}
+
+void acq_set_trigger(uint8_t trig)
+{
+    uint16_t shs;
+
+    switch (trig)
+    {
+    case ACQ_TRIG_TB0:
+        shs = ADC12SHS_2;
+        break;
+    case ACQ_TRIG_TA0:
+        shs = ADC12SHS_1;
+        break;
+    case ACQ_TRIG_GPIO:
+    case ACQ_TRIG_SOFTWARE:
+        shs = ADC12SHS_0;
+        break;
+    default:
+        return;
+    }
+
+    ADC12CTL0 &= ~ADC12ENC;                         // SHS can be changed only with ENC = 0
+    ADC12CTL1 = (ADC12CTL1 & ~ADC12SHS_3) | shs;
+    trigger = trig;
+    ADC12CTL0 |= ADC12ENC;
+}
+
+uint8_t acq_get_trigger(void)
+{
+    return trigger;
+}
+
+void acq_set_period(uint16_t period)
+{
+    // f_ACLK = 32768 Hz ID=1, TOGGLE outmod => T_OUT = 2 * T_CCR0 =>
+    // T_CCR0 = T_OUT/2 (TB0CCR0 = T_CCR0 - 1)
+    uint16_t s;
+
+    if (period < 4)
+        period = 4;
+
+    s = __get_interrupt_state();
+    __disable_interrupt();
+    TB0CCR0 = period/2 - 1;
+    if (TB0R >= TB0CCR0)        // already past new CCR0, would count up to 0xffff
+        TB0CTL |= TBCLR;
+    __set_interrupt_state(s);
+}
+
+void acq_convert(void)
+{
+    if ((trigger == ACQ_TRIG_SOFTWARE) || (trigger == ACQ_TRIG_GPIO))
+        ADC12CTL0 |= ADC12SC;   // start ADC12 conversion
+}
+
+void acq_arm(uint8_t pre, uint8_t post, uint8_t event, uint16_t level)
+{
+    uint16_t s = __get_interrupt_state();
+
+    if (post == 0)
+        post = 1;
+    if (post > ACQ_BUF_SIZE)
+        post = ACQ_BUF_SIZE;
+    if (pre > ACQ_BUF_SIZE - post)
+        pre = ACQ_BUF_SIZE - post;
+
+    __disable_interrupt();
+    pre_len = pre;
+    post_len = post;
+    evt = event;
+    threshold = level;
+    prev = 0xffff;              // no crossing on the first sample
+    head = 0;
+    count = 0;
+    state = ACQ_ARMED;
+    __set_interrupt_state(s);
+}
+
+void acq_event(uint8_t event)
+{
+    uint16_t s = __get_interrupt_state();
+
+    if ((event == ACQ_EVT_BUTTON) && (trigger == ACQ_TRIG_GPIO))
+        acq_convert();
+
+    __disable_interrupt();
+    if ((state == ACQ_ARMED) && (evt == event))
+        trigger_burst(0);
+    __set_interrupt_state(s);
+}
+
+uint8_t acq_state(void)
+{
+    return state;
+}
+
+void acq_window(uint8_t *pre, uint8_t *post)
+{
+    *pre = pre_cnt;
+    *post = post_len;
+}
+
+uint8_t acq_read(uint8_t pos, uint16_t *dst, uint8_t n)
+{
+    uint8_t len = pre_cnt + post_len;
+    uint8_t start = head - len;
+    uint8_t i;
+
+    // buffer is frozen, ISR does not touch it until next acq_arm()
+    if ((state != ACQ_DONE) || (pos >= len))
+        return 0;
+
+    if (n > len - pos)
+        n = len - pos;
+    for (i = 0; i < n; i++)
+        dst[i] = buf[(uint8_t)(start + pos + i) & (ACQ_BUF_SIZE - 1)];
+
+    return n;
+}
+
+void acq_sample(uint16_t sample)
+{
+    if ((state == ACQ_ARMED) || (state == ACQ_TRIGGERED))
+    {
+        buf[head & (ACQ_BUF_SIZE - 1)] = sample;
+        head++;
+        if (count < ACQ_BUF_SIZE)
+            count++;
+
+        if (state == ACQ_TRIGGERED)
+        {
+            if (--post_left == 0)
+                state = ACQ_DONE;
+        }
+        else if ((evt == ACQ_EVT_THRESHOLD) && (prev < threshold) && (sample >= threshold))
+        {
+            trigger_burst(1);       // crossing sample is the first post-trigger sample
+        }
+    }
+    prev = sample;
+}
+
+void acq_tick(irq_ctx_t *ctx)
+{
+    if (debounce == 0)
+        return;
+    if (--debounce != 0)
+        return;
+
+    if ((P1IN & BUTTON_PIN) == 0)   // check if button is still pressed
+        acq_event(ACQ_EVT_BUTTON);
+
+    P1IFG &= ~BUTTON_PIN;           // clear P1.4 flag
+    irq_unmask(ctx, IRQ_SRC_BUTTON);    // enable P1.4 interrupt through the policy
+}
+
+/**
+ * @brief PORT1 ISR
+ *
+ * Button press starts debounce, button is checked again in acq_tick().
+ */
+void __attribute__ ((interrupt(PORT1_VECTOR))) P1ISR (void)
+{
+    irq_ctx_t ctx;
+
+    ctx.entry = irq_now();
+    irq_enter(&ctx, IRQ_SRC_BUTTON);
+
+    if ((P1IFG & BUTTON_PIN) != 0)  // check if P1.4 flag is set
+    {
+        P1IFG &= ~BUTTON_PIN;       // clear P1.4 flag
+        P1IE &= ~BUTTON_PIN;        // disable P1.4 interrupt
+        debounce = DEBOUNCE_TICKS;
+    }
+
+    irq_exit(&ctx);
+}
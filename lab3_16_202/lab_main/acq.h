@@ -0,0 +1,146 @@
+/**
+ * @file acq.h
+ * @brief ADC12 acquisition front end
+ *
+ * Channel A0 (pot2) is converted on one of the trigger sources, which
+ * can be changed on the run:
+ *  - software: one conversion on every acq_convert()
+ *  - TB0: TB0.0 OUT -> ADC12SHS_2, period set with acq_set_period()
+ *  - TA0: TA0.1 OUT -> ADC12SHS_1, once per PWM period, at its start,
+ *    PWM period has to be at least ACQ_TA0_PERIOD_MIN
+ *  - GPIO: one conversion on every debounced press of button on P1.4
+ *
+ * In burst mode samples are kept in a circular buffer. When the
+ * selected event (button press, software request or threshold
+ * crossing) happens, 'post' more samples are captured and the buffer
+ * is frozen with up to 'pre' samples from before the event.
+ *
+ * @date 19.10.2026.
+ * @author  Andrea Ciric (andreaciric23@gmail.com)
+ *
+ * @version [1.0 - 10/2026] Initial version for MSP430F5529
+ *
+ */
+
+#ifndef ACQ_H_
+#define ACQ_H_
+
+#include <stdint.h>
+#include "irq.h"
+
+/**
+ * @brief Trigger sources
+ */
+#define ACQ_TRIG_SOFTWARE   (0)
+#define ACQ_TRIG_TB0        (1)
+#define ACQ_TRIG_TA0        (2)
+#define ACQ_TRIG_GPIO       (3)
+#define ACQ_TRIG_COUNT      (4)
+
+#define ACQ_TA0_PERIOD_MIN  (3)     // TA0.1 resets at TA0CCR1 = 1, sets at TA0CCR0, they must differ
+
+/**
+ * @brief Burst events
+ */
+#define ACQ_EVT_SOFTWARE    (0)     // acq_event(ACQ_EVT_SOFTWARE)
+#define ACQ_EVT_BUTTON      (1)     // debounced press of button on P1.4
+#define ACQ_EVT_THRESHOLD   (2)     // sample crosses level upwards
+
+/**
+ * @brief Burst states
+ */
+#define ACQ_IDLE            (0)
+#define ACQ_ARMED           (1)     // collecting pre-trigger samples, waiting for event
+#define ACQ_TRIGGERED       (2)     // collecting post-trigger samples
+#define ACQ_DONE            (3)     // buffer frozen, ready for readout
+
+#define ACQ_BUF_SIZE        (64)    // must be power of 2, pre + post <= ACQ_BUF_SIZE
+
+/**
+ * @brief Default TB0 trigger period
+ *
+ * TB0 is clocked by ACLK (32768Hz).
+ * No divider is set.
+ * We want 16Hz frequency, so use 2048
+ */
+#define CONV_PERIOD        (2048)  /* ~62.5 ms */
+
+/**
+ * @brief Initialize ADC12 on A0, TB0 trigger and button on P1.4
+ * @param trig - initial trigger source (ACQ_TRIG_x)
+ */
+extern void acq_init(uint8_t trig);
+
+/**
+ * @brief Change trigger source on the run
+ * @param trig - trigger source (ACQ_TRIG_x)
+ */
+extern void acq_set_trigger(uint8_t trig);
+
+/**
+ * @brief Current trigger source
+ */
+extern uint8_t acq_get_trigger(void);
+
+/**
+ * @brief Change TB0 trigger period
+ * @param period - period in ACLK cycles, 4..65534
+ */
+extern void acq_set_period(uint16_t period);
+
+/**
+ * @brief Start one conversion, used in software and GPIO mode
+ */
+extern void acq_convert(void);
+
+/**
+ * @brief Arm burst capture
+ * @param pre - number of samples kept from before the event
+ * @param post - number of samples captured after the event, at least 1
+ * @param event - event that ends pre-trigger phase (ACQ_EVT_x)
+ * @param level - threshold for ACQ_EVT_THRESHOLD, 0..4095
+ */
+extern void acq_arm(uint8_t pre, uint8_t post, uint8_t event, uint16_t level);
+
+/**
+ * @brief Signal an event
+ * @param event - ACQ_EVT_SOFTWARE or ACQ_EVT_BUTTON
+ */
+extern void acq_event(uint8_t event);
+
+/**
+ * @brief Current burst state (ACQ_IDLE, ...)
+ */
+extern uint8_t acq_state(void);
+
+/**
+ * @brief Burst window, valid in ACQ_DONE state
+ * @param pre - number of samples from before the event
+ * @param post - number of samples from the event on
+ */
+extern void acq_window(uint8_t *pre, uint8_t *post);
+
+/**
+ * @brief Copy samples of a finished burst
+ * @param pos - index of the first sample, 0 is the oldest one
+ * @param dst - where samples are copied
+ * @param n - max number of samples
+ * @return number of samples copied, 0 if burst is not in ACQ_DONE state
+ *
+ * Buffer stays frozen until the next acq_arm(), so it can be read
+ * in parts and more than once.
+ */
+extern uint8_t acq_read(uint8_t pos, uint16_t *dst, uint8_t n);
+
+/**
+ * @brief Feed one conversion result, called from ADC12 ISR
+ */
+extern void acq_sample(uint16_t sample);
+
+/**
+ * @brief Button debounce, called from the 5ms tick ISR
+ * @param ctx - context of the tick ISR, button is enabled again through it
+ */
+extern void acq_tick(irq_ctx_t *ctx);
+
+#endif /* ACQ_H_ */
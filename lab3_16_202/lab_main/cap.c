@@ -0,0 +1,257 @@
+/**
+ * @file cap.c
+ * @brief Edge capture on TA2.2 with DMA
+ *
+ * cap_service() reads how many captures DMA has moved and then the 32bit
+ * time. Every new capture happened before that time and after the
+ * previous call, so when calls are less than one TA2 period apart the
+ * high word of each capture is the only one which puts it at most one
+ * period before the time read. If the calls are further apart a capture
+ * can not be placed, so the block is discarded instead.
+ *
+ * @date 19.10.2026.
+ * @author  Andrea Ciric (andreaciric23@gmail.com)
+ *
+ * @version [1.0 - 10/2026] Initial version for MSP430F5529
+ *
+ */
+
+#include <msp430.h>
+#include <stdint.h>
+#include "cap.h"
+#include "irq.h"
+
+#define CAP_PIN         (BIT5)      // P2.5 - TA2.2 CCI2A
+#define LEVEL_WAIT      (12)        // MCLK cycles, more than capture sync + DMA transfer
+#define LEVEL_TRIES     (16)        // fast signal may never leave a quiet window
+
+static volatile uint16_t buf[CAP_BUF_SIZE];     // written by DMA
+static volatile uint16_t ovf_hi = 0;            // high word of cap_now()
+
+static cap_result_t result;
+
+/* measurement in progress */
+static uint8_t done;                // captures processed
+static uint32_t seen;               // time of the last call, older captures are extended
+static uint8_t level;               // signal level after the last processed edge
+static uint8_t level_ok;            // 0 - start level not known, rises and falls may be swapped
+static uint16_t rises;
+static uint32_t first_rise, last_rise;
+static uint32_t high;               // high time of the current period
+static uint32_t high_sum;           // high time of all full periods
+
+/**
+ * @brief Number of captures moved by DMA in the current block
+ */
+static uint8_t moved(void)
+{
+    uint16_t left = DMA0SZ;         // read before DMAEN, size is reloaded at block end
+
+    if ((DMA0CTL & DMAEN) == 0)
+        return CAP_BUF_SIZE;
+    return CAP_BUF_SIZE - left;
+}
+
+/**
+ * @brief Start new block
+ */
+static void start(void)
+{
+    uint8_t k1, k2, in, i;
+    uint16_t state = __get_interrupt_state();
+
+    __disable_interrupt();
+    seen = cap_now();               // every capture of the block comes later
+
+    __data16_write_addr((unsigned short) &DMA0DA, (unsigned long) buf);
+    DMA0SZ = CAP_BUF_SIZE;
+    DMA0CTL |= DMAEN;
+    // trigger is the CCIFG edge, so the flag is cleared only once DMA
+    // is armed, a capture in between is moved and not lost to COV
+    TA2CCTL2 &= ~(COV | CCIFG);
+
+    // level before the first capture, edges may already come in. CCI
+    // follows the pin before the capture is synchronised and moved, so
+    // a capture seen by CCI shows up in moved() only after LEVEL_WAIT
+    level_ok = 0;
+    for (i = 0; (i < LEVEL_TRIES) && (level_ok == 0); i++)
+    {
+        k1 = moved();
+        in = ((TA2CCTL2 & CCI) != 0) ? 1 : 0;
+        __delay_cycles(LEVEL_WAIT);
+        k2 = moved();
+        if (k1 == k2)
+        {
+            level = in ^ (k1 & 1);
+            level_ok = 1;
+        }
+    }
+    __set_interrupt_state(state);
+
+    done = 0;
+    rises = 0;
+    high = 0;
+    high_sum = 0;
+}
+
+static void rise(uint32_t t)
+{
+    if (rises == 0)
+        first_rise = t;
+    else
+        high_sum += high;           // period which ends here is full
+    high = 0;
+    last_rise = t;
+    rises++;
+}
+
+static void fall(uint32_t t)
+{
+    if (rises != 0)
+        high = t - last_rise;
+}
+
+static void finish(void)
+{
+    uint32_t span = last_rise - first_rise;
+    uint16_t periods = rises - 1;
+
+    if (rises >= 2)
+    {
+        result.period = span / periods;
+        result.freq = (SMCLK_HZ * periods + span / 2) / span;
+        if (level_ok != 0)
+            result.duty = ((uint64_t)high_sum * 1000 + span / 2) / span;
+        else
+            result.duty = CAP_DUTY_UNKNOWN;
+    }
+    else
+    {
+        result.period = 0;
+        result.freq = 0;
+        result.duty = 0;
+        periods = 0;
+    }
+    result.periods = periods;
+    result.blocks++;
+}
+
+void cap_init(void)
+{
+    P2SEL |= CAP_PIN;               // P2.5 is TA2.2 input
+    P2DIR &= ~CAP_PIN;
+
+    TA2CCTL2 = CM_3 | CCIS_0 | SCS | CAP;   // both edges, CCI2A, synchronous capture
+
+    DMACTL0 = (DMACTL0 & ~DMA0TSEL_31) | DMA0TSEL_6;   // DMA0 trigger is TA2CCR2 CCIFG
+    __data16_write_addr((unsigned short) &DMA0SA, (unsigned long) &TA2CCR2);
+    DMA0CTL = DMADT_0 | DMASRCINCR_0 | DMADSTINCR_3;    // single word transfers, to buf[0..]
+
+    TA2CTL |= TAIE;                 // count overflows
+
+    result.blocks = 0;
+    result.missed = 0;
+    start();
+}
+
+void cap_service(void)
+{
+    uint8_t n;
+    uint32_t now, t;
+    uint16_t state;
+
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    n = moved();                    // first, so all n captures are older than now
+    now = cap_now();
+    __set_interrupt_state(state);
+
+    if (((TA2CCTL2 & COV) != 0) || ((n != done) && (now - seen >= 0x10000UL)))
+    {
+        cap_restart();
+        return;
+    }
+    seen = now;
+
+    while (done != n)
+    {
+        t = (now & 0xffff0000UL) | buf[done];
+        if (t > now)                // wrapped between capture and now
+            t -= 0x10000UL;
+
+        level ^= 1;
+        if (level != 0)
+            rise(t);
+        else
+            fall(t);
+        done++;
+    }
+
+    if (done == CAP_BUF_SIZE)
+    {
+        finish();
+        start();
+    }
+}
+
+void cap_restart(void)
+{
+    DMA0CTL &= ~DMAEN;
+    result.missed++;
+    start();
+}
+
+uint32_t cap_now(void)
+{
+    uint16_t h, l;
+    uint16_t state = __get_interrupt_state();
+
+    __disable_interrupt();
+    l = TA2R;
+    h = ovf_hi;
+    if (((TA2CTL & TAIFG) != 0) && (l < 0x8000))
+        h++;                        // wrapped, ISR has not run yet
+    __set_interrupt_state(state);
+
+    return ((uint32_t)h << 16) | l;
+}
+
+uint8_t cap_read(uint8_t *dst)
+{
+    dst[0] = result.period;
+    dst[1] = result.period >> 8;
+    dst[2] = result.period >> 16;
+    dst[3] = result.period >> 24;
+    dst[4] = result.freq;
+    dst[5] = result.freq >> 8;
+    dst[6] = result.freq >> 16;
+    dst[7] = result.freq >> 24;
+    dst[8] = result.duty;
+    dst[9] = result.duty >> 8;
+    dst[10] = result.periods;
+    dst[11] = result.periods >> 8;
+    dst[12] = result.blocks;
+    dst[13] = result.blocks >> 8;
+    dst[14] = result.missed;
+    dst[15] = result.missed >> 8;
+
+    return CAP_RESULT_SIZE;
+}
+
+/**
+ * @brief TIMER2_A1 ISR
+ *
+ * TA2 overflow, kept minimal: it is not part of the nesting policy
+ * and can preempt nested ISRs.
+ */
+void __attribute__ ((interrupt(TIMER2_A1_VECTOR))) TA2ISR (void)
+{
+    switch (TA2IV)
+    {
+    case TA2IV_TA2IFG:
+        ovf_hi++;
+        break;
+    default:
+        break;
+    }
+}
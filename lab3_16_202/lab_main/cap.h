@@ -0,0 +1,86 @@
+/**
+ * @file cap.h
+ * @brief Edge capture on TA2.2 with DMA
+ *
+ * TA2 runs free on SMCLK (see irq.h). CCR2 captures both edges of the
+ * signal on P2.5 (CCI2A) and DMA channel 0, triggered by TA2CCR2,
+ * moves every 16bit capture into a buffer, so edges cost no CPU time.
+ * TA2 overflow ISR only counts overflows, cap_service() then extends
+ * captures to 32 bits.
+ *
+ * One measurement is a block of CAP_BUF_SIZE edges. Period and
+ * frequency are averaged over all full periods in the block and duty
+ * is the sum of high times over the same span. Period resolution is
+ * one SMCLK cycle over the whole block, so fast signals are measured
+ * as precisely as slow ones. Edges have to be at least ~8 SMCLK cycles
+ * apart (DMA transfer), which is ~500kHz for 50% duty signal. Duty needs
+ * the signal level at block start, read while no edge is in flight, so
+ * with edges closer than ~25 cycles (~160kHz at 50% duty) it may be
+ * reported unknown. A block
+ * with a lost capture (COV) is discarded.
+ *
+ * @date 19.10.2026.
+ * @author  Andrea Ciric (andreaciric23@gmail.com)
+ *
+ * @version [1.0 - 10/2026] Initial version for MSP430F5529
+ *
+ */
+
+#ifndef CAP_H_
+#define CAP_H_
+
+#include <stdint.h>
+
+#define CAP_BUF_SIZE        (64)    // edges in one measurement
+
+/**
+ * @brief Result of the last complete measurement
+ */
+typedef struct
+{
+    uint32_t period;        // average period in SMCLK cycles, 0 - no full period
+    uint32_t freq;          // frequency in Hz, rounded
+    uint16_t duty;          // high time in 1/1000 of period, CAP_DUTY_UNKNOWN
+    uint16_t periods;       // number of full periods in the block
+    uint16_t blocks;        // complete measurements, wraps around
+    uint16_t missed;        // discarded measurements, capture lost or service too late
+} cap_result_t;
+
+#define CAP_RESULT_SIZE     (16)    // bytes written by cap_read()
+#define CAP_DUTY_UNKNOWN    (0xffff)    // signal level at block start could not be read
+
+/**
+ * @brief Configure P2.5, TA2 CCR2 capture, DMA0 and TA2 overflow interrupt,
+ * then start the first measurement. TA2 must be already started by irq_init().
+ */
+extern void cap_init(void);
+
+/**
+ * @brief Extend new captures and finish the measurement, called from main loop
+ *
+ * Has to be called at least once per TA2 period (~8.2ms) while edges
+ * come in, otherwise the block is discarded.
+ */
+extern void cap_service(void);
+
+/**
+ * @brief Discard the measurement in progress and start a new one
+ *
+ * For code which held interrupts off longer than one TA2 period (flash
+ * erase), overflows were lost and new captures can not be placed.
+ */
+extern void cap_restart(void);
+
+/**
+ * @brief 32bit TA2 timestamp in SMCLK cycles, wraps every ~9 minutes
+ */
+extern uint32_t cap_now(void);
+
+/**
+ * @brief Last result, little endian in the order of cap_result_t
+ * @param dst - CAP_RESULT_SIZE bytes
+ * @return number of bytes written
+ */
+extern uint8_t cap_read(uint8_t *dst);
+
+#endif /* CAP_H_ */
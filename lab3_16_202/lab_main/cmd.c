@@ -0,0 +1,229 @@
+/**
+ * @file cmd.c
+ * @brief Binary command dispatcher over UART
+ *
+ * Parser takes bytes from the UART RX buffer in main loop, so handlers
+ * never run inside an ISR. Only the inter-byte gap counter is shared
+ * with the tick ISR.
+ *
+ * @date 19.10.2026.
+ * @author  Andrea Ciric (andreaciric23@gmail.com)
+ *
+ * @version [1.0 - 10/2026] Initial version for MSP430F5529
+ *
+ */
+
+#include <msp430.h>
+#include <stdint.h>
+#include "cmd.h"
+#include "uart.h"
+#include "cap.h"
+
+#define STAT_INC(x)     do { if ((x) != 0xffff) (x)++; } while (0)
+
+/**
+ * @brief Parser states
+ */
+#define ST_SYNC         (0)     // waiting for CMD_SYNC_REQ
+#define ST_OPCODE       (1)
+#define ST_LEN          (2)
+#define ST_ARG          (3)
+#define ST_CHK          (4)
+#define ST_READY        (5)     // frame complete, waiting for TX room
+
+static cmd_stats_t stats;
+static const cmd_entry_t *table;
+static uint8_t table_len;
+
+static uint8_t state = ST_SYNC;
+static uint8_t opcode, len, pos, chk;
+static uint8_t arg[CMD_DATA_MAX];
+static uint8_t status;                      // CMD_OK or error found by the parser
+static uint32_t t_frame;                    // time when the frame was complete
+static uint8_t deferred;                    // frame already counted as deferred
+static volatile uint8_t gap = 0;            // ticks since last received byte
+
+/**
+ * @brief Check complete frame against the table
+ */
+static uint8_t check_frame(uint8_t sum)
+{
+    if (sum != 0)
+    {
+        STAT_INC(stats.checksum);
+        return CMD_ERR_CHECKSUM;
+    }
+    if ((opcode >= table_len) || (table[opcode].fn == 0))
+    {
+        STAT_INC(stats.opcode);
+        return CMD_ERR_OPCODE;
+    }
+    if ((table[opcode].arg_len != CMD_ANY_LEN) && (table[opcode].arg_len != len))
+    {
+        STAT_INC(stats.length);
+        return CMD_ERR_LEN;
+    }
+    return CMD_OK;
+}
+
+/**
+ * @brief Feed one received byte to the parser
+ */
+static void parse(uint8_t c)
+{
+    switch (state)
+    {
+    case ST_SYNC:
+        if (c == CMD_SYNC_REQ)
+            state = ST_OPCODE;
+        break;
+    case ST_OPCODE:
+        opcode = c;
+        chk = c;
+        state = ST_LEN;
+        break;
+    case ST_LEN:
+        if (c > CMD_DATA_MAX)
+        {
+            STAT_INC(stats.length);     // frame end is unknown, resync
+            state = ST_SYNC;
+            break;
+        }
+        len = c;
+        chk ^= c;
+        pos = 0;
+        state = (len == 0) ? ST_CHK : ST_ARG;
+        break;
+    case ST_ARG:
+        arg[pos++] = c;
+        chk ^= c;
+        if (pos == len)
+            state = ST_CHK;
+        break;
+    case ST_CHK:
+        t_frame = cap_now();
+        status = check_frame(chk ^ c);
+        deferred = 0;
+        state = ST_READY;
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Run handler and queue the reply
+ *
+ * TX room for the whole reply is already checked.
+ */
+static void dispatch(void)
+{
+    uint8_t reply[CMD_DATA_MAX];
+    uint8_t reply_len = 0;
+    uint8_t i, sum;
+    uint32_t latency;
+
+    if (status == CMD_OK)
+        status = table[opcode].fn(arg, len, reply, &reply_len);
+    if ((status != CMD_OK) || (reply_len > CMD_DATA_MAX))
+        reply_len = 0;
+
+    sum = opcode ^ status ^ reply_len;
+    uart_putc(CMD_SYNC_REPLY);
+    uart_putc(opcode);
+    uart_putc(status);
+    uart_putc(reply_len);
+    for (i = 0; i < reply_len; i++)
+    {
+        uart_putc(reply[i]);
+        sum ^= reply[i];
+    }
+    uart_putc(sum);
+
+    latency = cap_now() - t_frame;
+    if (latency > 0xffff)
+        latency = 0xffff;
+    stats.latency_last = latency;
+    if (latency > stats.latency_max)
+        stats.latency_max = latency;
+    STAT_INC(stats.frames);
+
+    state = ST_SYNC;
+}
+
+void cmd_init(const cmd_entry_t *t, uint8_t count)
+{
+    table = t;
+    table_len = count;
+    state = ST_SYNC;
+    cmd_clear_stats();
+}
+
+void cmd_service(void)
+{
+    int16_t c;
+    uint8_t room;
+
+    while (state != ST_READY)
+    {
+        c = uart_getc();
+        if (c < 0)
+        {
+            // RX buffer is empty, so a long gap is not caused by slow main loop
+            if ((state != ST_SYNC) && (gap >= CMD_TIMEOUT))
+            {
+                STAT_INC(stats.timeout);
+                state = ST_SYNC;
+            }
+            return;
+        }
+        gap = 0;
+        parse(c);
+    }
+
+    room = CMD_OVERHEAD;
+    if (status == CMD_OK)
+        room += table[opcode].reply_max;
+
+    if (uart_tx_free() < room)
+    {
+        if (deferred == 0)
+            STAT_INC(stats.deferred);
+        deferred = 1;
+        return;
+    }
+
+    dispatch();
+}
+
+void cmd_tick(void)
+{
+    if (gap != 0xff)
+        gap++;
+}
+
+uint8_t cmd_read_stats(uint8_t *dst)
+{
+    CMD_PUT16(dst, stats.frames);
+    CMD_PUT16(dst + 2, stats.checksum);
+    CMD_PUT16(dst + 4, stats.length);
+    CMD_PUT16(dst + 6, stats.opcode);
+    CMD_PUT16(dst + 8, stats.timeout);
+    CMD_PUT16(dst + 10, stats.deferred);
+    CMD_PUT16(dst + 12, stats.latency_last);
+    CMD_PUT16(dst + 14, stats.latency_max);
+
+    return CMD_STATS_SIZE;
+}
+
+void cmd_clear_stats(void)
+{
+    stats.frames = 0;
+    stats.checksum = 0;
+    stats.length = 0;
+    stats.opcode = 0;
+    stats.timeout = 0;
+    stats.deferred = 0;
+    stats.latency_last = 0;
+    stats.latency_max = 0;
+}
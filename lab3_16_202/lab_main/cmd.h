@@ -0,0 +1,134 @@
+/**
+ * @file cmd.h
+ * @brief Binary command dispatcher over UART
+ *
+ * Request: CMD_SYNC_REQ, opcode, len, arg[len], chk
+ * Reply:   CMD_SYNC_REPLY, opcode, status, len, data[len], chk
+ *
+ * chk is XOR of all bytes between sync and chk, multibyte values are
+ * little endian. Opcode is an index into the table of handlers given
+ * to cmd_init(). Every entry says how many argument bytes the command
+ * takes and how long its reply can be. Every request gets exactly one
+ * reply, in order.
+ *
+ * A complete frame is dispatched only when TX buffer has room for the
+ * whole reply. Until then the parser stops reading, RX buffer fills up
+ * and with flow control the PC gets throttled, so neither side blocks
+ * and no reply is dropped. Frames are binary, so UART_FLOW_XONXOFF must
+ * not be used: 0x11/0x13 in the arguments would be taken by the driver.
+ *
+ * Frame which is not completed within CMD_TIMEOUT ticks after its last
+ * byte is discarded and the parser waits for the next sync byte.
+ *
+ * @date 19.10.2026.
+ * @author  Andrea Ciric (andreaciric23@gmail.com)
+ *
+ * @version [1.0 - 10/2026] Initial version for MSP430F5529
+ *
+ */
+
+#ifndef CMD_H_
+#define CMD_H_
+
+#include <stdint.h>
+
+#define CMD_SYNC_REQ        (0xa5)
+#define CMD_SYNC_REPLY      (0x5a)
+
+#define CMD_DATA_MAX        (24)    // longest argument and reply, reply_max + CMD_OVERHEAD <= UART_TX_SIZE
+#define CMD_OVERHEAD        (5)     // reply bytes besides data
+#define CMD_ANY_LEN         (0xff)  // arg_len of command with variable argument length
+#define CMD_TIMEOUT         (4)     // ticks (20ms at 5ms tick), 9600 bps byte takes ~1ms
+
+/**
+ * @brief Reply status
+ */
+#define CMD_OK              (0)
+#define CMD_ERR_OPCODE      (1)     // no handler for opcode
+#define CMD_ERR_LEN         (2)     // wrong argument length
+#define CMD_ERR_ARG         (3)     // argument out of range
+#define CMD_ERR_STATE       (4)     // command not possible right now
+#define CMD_ERR_CHECKSUM    (5)
+
+/**
+ * @brief Little endian helpers for handlers
+ */
+#define CMD_GET16(p)        ((uint16_t)(p)[0] | ((uint16_t)(p)[1] << 8))
+#define CMD_PUT16(p, v)     do { (p)[0] = (v); (p)[1] = (v) >> 8; } while (0)
+
+/**
+ * @brief Command handler
+ * @param arg - argument bytes
+ * @param len - number of argument bytes
+ * @param reply - CMD_DATA_MAX bytes for reply data
+ * @param reply_len - number of reply bytes, 0 on entry
+ * @return reply status (CMD_OK, CMD_ERR_x), reply data is sent only with CMD_OK
+ *
+ * Called from main loop, must not wait for anything.
+ */
+typedef uint8_t (*cmd_fn_t)(const uint8_t *arg, uint8_t len, uint8_t *reply, uint8_t *reply_len);
+
+/**
+ * @brief Jump table entry, table is indexed by opcode
+ */
+typedef struct
+{
+    cmd_fn_t fn;
+    uint8_t arg_len;        // exact argument length or CMD_ANY_LEN
+    uint8_t reply_max;      // longest reply data, TX room is reserved for it
+} cmd_entry_t;
+
+/**
+ * @brief Dispatcher statistics
+ *
+ * Counters saturate at 0xffff. Latency is in SMCLK cycles (cap_now()),
+ * from the moment the checksum byte is taken from RX buffer to the
+ * moment the reply is queued, including the wait for TX room. It also
+ * saturates at 0xffff (~8.2ms).
+ */
+typedef struct
+{
+    uint16_t frames;        // replied frames
+    uint16_t checksum;      // frames with bad checksum
+    uint16_t length;        // frames with bad argument length
+    uint16_t opcode;        // frames with unknown opcode
+    uint16_t timeout;       // incomplete frames discarded
+    uint16_t deferred;      // frames which waited for TX room
+    uint16_t latency_last;
+    uint16_t latency_max;
+} cmd_stats_t;
+
+#define CMD_STATS_SIZE      (16)    // bytes written by cmd_read_stats()
+
+/**
+ * @brief Set the table of handlers and clear stats
+ * @param table - handlers indexed by opcode, NULL fn means unused opcode
+ * @param count - number of entries
+ */
+extern void cmd_init(const cmd_entry_t *table, uint8_t count);
+
+/**
+ * @brief Parse received bytes and dispatch complete frame, called from main loop
+ */
+extern void cmd_service(void);
+
+/**
+ * @brief Count ticks since the last received byte, called from the tick ISR
+ */
+extern void cmd_tick(void);
+
+/**
+ * @brief Take a snapshot of stats block
+ * @param dst - CMD_STATS_SIZE bytes
+ * @return number of bytes written
+ *
+ * Counters are written in the order of cmd_stats_t, 16bit little endian.
+ */
+extern uint8_t cmd_read_stats(uint8_t *dst);
+
+/**
+ * @brief Clear all stats counters
+ */
+extern void cmd_clear_stats(void);
+
+#endif /* CMD_H_ */
@@ -0,0 +1,317 @@
+/**
+ * @file ctrl.c
+ * @brief Fixed rate control stage between ADC12 and PWM
+ *
+ * ctrl_step() runs in the nested part of the ADC12 ISR, so UART may
+ * preempt it. MPY32 is also used by compiler generated code in other
+ * ISRs, so its operand and result registers are accessed with
+ * interrupts disabled, which is only a few cycles.
+ *
+ * Output of a step is queued in 'next' and written to TA0CCR2 by the
+ * TA0CCR0 ISR. TA0CCR0 CCIFG is set when TA0R counts to TA0CCR0, one
+ * ACLK cycle (~244 MCLK cycles) before the new period starts. If the
+ * ISR is not blocked longer than that (see irq_read_stats()), the new
+ * compare value is in place before TA0R can reach it, so no pulse is
+ * cut or doubled.
+ *
+ * @date 19.10.2026.
+ * @author  Andrea Ciric (andreaciric23@gmail.com)
+ *
+ * @version [1.0 - 10/2026] Initial version for MSP430F5529
+ *
+ */
+
+#include <msp430.h>
+#include <stdint.h>
+#include "ctrl.h"
+#include "irq.h"
+#include "cap.h"
+
+#define OUT_FULL        ((int32_t)CTRL_OUT_MAX << CTRL_Q)   // 100% in accumulator scale
+#define STAT_INC(x)     do { if ((x) != 0xffff) (x)++; } while (0)
+
+/**
+ * @brief Source of the queued duty
+ */
+#define NEXT_NONE       (0)
+#define NEXT_STEP       (1)     // controller output, the next one is due one period later
+#define NEXT_LATCH      (2)     // ctrl_latch(), no output is due after it
+
+static volatile uint8_t mode = CTRL_OPEN;
+static volatile int16_t setpoint = 0;
+static volatile int16_t kp = 0x0800;        // 0.5
+static volatile int16_t ki = 0x0200;        // 0.125
+static volatile int16_t kd = 0;
+
+static int32_t integ = 0;                   // integrator, Q12 output << CTRL_Q
+static int16_t y_prev = 0;                  // previous measurement
+static uint16_t out = 0;                    // last output, 0..CTRL_OUT_MAX
+
+static volatile uint16_t next;              // duty for the next PWM period
+static volatile uint8_t next_src = NEXT_NONE;
+static volatile uint8_t due = 0;            // 1 - a step output is expected at the next boundary
+
+static volatile ctrl_stats_t stats;
+static uint16_t last_period = 0;            // PWM period of the interval being measured
+static uint32_t t_last;                     // start of the previous step
+static uint32_t ival_min, ival_max;
+static uint32_t t_clear;                    // cap_now() at ctrl_clear_stats()
+
+/**
+ * @brief Track time between iteration starts
+ */
+static void account(uint32_t now, uint16_t period)
+{
+    uint32_t ival, spread;
+
+    if (period != last_period)
+    {
+        last_period = period;           // new nominal interval, restart
+        ival_min = 0xffffffffUL;
+        ival_max = 0;
+        stats.jitter = 0;
+    }
+    else
+    {
+        ival = now - t_last;
+        stats.interval = ival;
+        if (ival < ival_min)
+            ival_min = ival;
+        if (ival > ival_max)
+            ival_max = ival;
+        spread = ival_max - ival_min;
+        stats.jitter = (spread > 0xffff) ? 0xffff : spread;
+    }
+    t_last = now;
+}
+
+/**
+ * @brief PID step in accumulator scale
+ * @return output, 0..CTRL_OUT_MAX
+ */
+static uint16_t pid(int16_t y)
+{
+    int16_t e = setpoint - y;
+    int16_t dy = y_prev - y;
+    int32_t pd, di, acc;
+    uint16_t state;
+
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    MPYS = kp;                      // pd = kp x e + kd x dy
+    OP2 = e;
+    MACS = kd;
+    OP2 = dy;
+    pd = (int32_t)(((uint32_t)RESHI << 16) | RESLO);
+    MPYS = ki;                      // di = ki x e
+    OP2 = e;
+    di = (int32_t)(((uint32_t)RESHI << 16) | RESLO);
+    __set_interrupt_state(state);
+
+    y_prev = y;
+
+    // conditional integration, integrator does not wind up into saturation
+    acc = pd + integ;
+    if (((acc < OUT_FULL) || (di < 0)) && ((acc > 0) || (di > 0)))
+    {
+        integ += di;
+        if (integ > OUT_FULL)
+            integ = OUT_FULL;
+        else if (integ < 0)
+            integ = 0;
+        acc = pd + integ;
+    }
+
+    if (acc > OUT_FULL)
+    {
+        STAT_INC(stats.saturated);
+        return CTRL_OUT_MAX;
+    }
+    if (acc < 0)
+    {
+        STAT_INC(stats.saturated);
+        return 0;
+    }
+    return (acc + (1L << (CTRL_Q - 1))) >> CTRL_Q;
+}
+
+void ctrl_init(uint16_t duty)
+{
+    next = duty;
+    next_src = NEXT_NONE;
+    due = 0;
+    ctrl_clear_stats();
+
+    TA0CCTL0 = CCIE;                // PWM boundary, TA0CCR0 CCIFG
+}
+
+void ctrl_set_mode(uint8_t m)
+{
+    uint16_t state = __get_interrupt_state();
+
+    __disable_interrupt();          // ADC ISR uses controller state
+    if ((m == CTRL_PID) && (mode != CTRL_PID))
+    {
+        integ = (int32_t)out << CTRL_Q;     // bumpless, start from the last output
+        y_prev = stats.sample;
+    }
+    mode = m;
+    __set_interrupt_state(state);
+}
+
+uint8_t ctrl_get_mode(void)
+{
+    return mode;
+}
+
+void ctrl_set_params(uint16_t sp, uint16_t p, uint16_t i, uint16_t d)
+{
+    uint16_t state = __get_interrupt_state();
+
+    __disable_interrupt();
+    setpoint = sp;
+    kp = p;
+    ki = i;
+    kd = d;
+    __set_interrupt_state(state);
+}
+
+uint8_t ctrl_get_params(uint8_t *dst)
+{
+    dst[0] = setpoint;
+    dst[1] = setpoint >> 8;
+    dst[2] = kp;
+    dst[3] = kp >> 8;
+    dst[4] = ki;
+    dst[5] = ki >> 8;
+    dst[6] = kd;
+    dst[7] = kd >> 8;
+
+    return CTRL_PARAMS_SIZE;
+}
+
+uint16_t ctrl_step(uint16_t sample, uint16_t period)
+{
+    uint16_t t0 = irq_now();
+    uint16_t duty, cycles, state;
+
+    account(cap_now(), period);
+
+    sample &= 0xfff;
+    if (mode == CTRL_PID)
+    {
+        out = pid(sample);
+    }
+    else
+    {
+        out = sample;
+        integ = (int32_t)out << CTRL_Q;
+        y_prev = sample;
+    }
+    duty = ((uint32_t)out * period) >> CTRL_Q;
+
+    state = __get_interrupt_state();
+    __disable_interrupt();          // boundary ISR takes the queued duty
+    if (next_src == NEXT_STEP)
+        STAT_INC(stats.overruns);   // previous output was not latched yet
+    next = duty;
+    next_src = NEXT_STEP;
+    __set_interrupt_state(state);
+
+    stats.iterations++;
+    stats.sample = sample;
+    stats.output = out;
+    cycles = irq_now() - t0;
+    stats.cycles_last = cycles;
+    if (cycles > stats.cycles_max)
+        stats.cycles_max = cycles;
+
+    return duty;
+}
+
+void ctrl_latch(uint16_t duty)
+{
+    uint16_t state = __get_interrupt_state();
+
+    __disable_interrupt();
+    next = duty;
+    next_src = NEXT_LATCH;
+    last_period = 0;                // steps stop or restart, gap is not jitter
+    __set_interrupt_state(state);
+}
+
+uint8_t ctrl_read_stats(uint8_t *dst)
+{
+    ctrl_stats_t s;
+    uint16_t state = __get_interrupt_state();
+
+    __disable_interrupt();          // take consistent snapshot
+    s = stats;
+    s.elapsed = cap_now() - t_clear;
+    __set_interrupt_state(state);
+
+    dst[0] = s.iterations;
+    dst[1] = s.iterations >> 8;
+    dst[2] = s.overruns;
+    dst[3] = s.overruns >> 8;
+    dst[4] = s.saturated;
+    dst[5] = s.saturated >> 8;
+    dst[6] = s.cycles_last;
+    dst[7] = s.cycles_last >> 8;
+    dst[8] = s.cycles_max;
+    dst[9] = s.cycles_max >> 8;
+    dst[10] = s.jitter;
+    dst[11] = s.jitter >> 8;
+    dst[12] = s.interval;
+    dst[13] = s.interval >> 8;
+    dst[14] = s.interval >> 16;
+    dst[15] = s.interval >> 24;
+    dst[16] = s.sample;
+    dst[17] = s.sample >> 8;
+    dst[18] = s.output;
+    dst[19] = s.output >> 8;
+    dst[20] = s.elapsed;
+    dst[21] = s.elapsed >> 8;
+    dst[22] = s.elapsed >> 16;
+    dst[23] = s.elapsed >> 24;
+
+    return CTRL_STATS_SIZE;
+}
+
+void ctrl_clear_stats(void)
+{
+    uint16_t state = __get_interrupt_state();
+
+    __disable_interrupt();
+    stats.iterations = 0;
+    stats.overruns = 0;
+    stats.saturated = 0;
+    stats.cycles_last = 0;
+    stats.cycles_max = 0;
+    stats.jitter = 0;
+    stats.interval = 0;
+    last_period = 0;                // restart jitter measurement
+    t_clear = cap_now();
+    __set_interrupt_state(state);
+}
+
+/**
+ * @brief TIMER0_A0 ISR
+ *
+ * PWM period boundary, latches the queued duty. Kept minimal: it is
+ * not part of the nesting policy and can preempt nested ISRs.
+ */
+void __attribute__ ((interrupt(TIMER0_A0_VECTOR))) PWMISR (void)
+{
+    if (next_src != NEXT_NONE)
+    {
+        TA0CCR2 = next;
+        due = (next_src == NEXT_STEP) ? 1 : 0;
+        next_src = NEXT_NONE;
+    }
+    else if (due != 0)
+    {
+        STAT_INC(stats.overruns);   // step did not finish within its period
+        due = 0;
+    }
+}
@@ -0,0 +1,143 @@
+/**
+ * @file ctrl.h
+ * @brief Fixed rate control stage between ADC12 and PWM
+ *
+ * ctrl_step() is called from the ADC12 ISR with every conversion and
+ * computes the next PWM duty. The duty is not written to TA0CCR2 right
+ * away, it is latched in the TA0CCR0 ISR at the next PWM period
+ * boundary, so a period never sees two compare values and the output
+ * is applied exactly one period after its sample.
+ *
+ * With ACQ_TRIG_TA0 the conversion is started by TA0.1 at the start of
+ * every PWM period, so the loop runs at the PWM rate, sample and output
+ * are both tied to ACLK and the controller has one period minus the
+ * conversion time (~10us) to finish. Other triggers are not
+ * synchronised to PWM and only the latch is kept.
+ *
+ * Modes:
+ *  - CTRL_OPEN: duty follows the sample, duty = sample x period / 4096
+ *  - CTRL_PID: PID towards the setpoint, sample is the measurement
+ *
+ * A0 is the pot on the board. For the closed loop the measured signal,
+ * e.g. P1.3 through an RC low pass, has to be connected to A0 instead.
+ *
+ * Controller works in Q12: output 0..CTRL_OUT_MAX is 0..100% of the
+ * period and gains are Q12 (4096 = 1.0) per ADC count of error.
+ *
+ *  u = kp x e + ki x sum(e) + kd x (y[k-1] - y[k])
+ *
+ * Derivative is taken on the measurement, so a setpoint step gives no
+ * kick. Products are 16 x 16 multiply-accumulate on MPY32. Anti-windup
+ * is conditional integration: the integrator is clamped to the output
+ * range and does not move while the output is saturated in the same
+ * direction.
+ *
+ * @date 19.10.2026.
+ * @author  Andrea Ciric (andreaciric23@gmail.com)
+ *
+ * @version [1.0 - 10/2026] Initial version for MSP430F5529
+ *
+ */
+
+#ifndef CTRL_H_
+#define CTRL_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Modes
+ */
+#define CTRL_OPEN           (0)
+#define CTRL_PID            (1)
+
+#define CTRL_Q              (12)                // fractional bits of gains and output
+#define CTRL_OUT_MAX        (1 << CTRL_Q)       // 100% duty
+#define CTRL_GAIN_MAX       (0x7fff)            // gains are signed MPY32 operands, < 8.0
+#define CTRL_SETPOINT_MAX   (0xfff)             // 12bit ADC
+
+/**
+ * @brief Loop statistics
+ *
+ * Times are in SMCLK cycles. Jitter is the spread (max - min) of the
+ * time between two iteration starts, it is restarted when PWM period
+ * changes.
+ */
+typedef struct
+{
+    uint16_t iterations;    // controller steps, wraps around
+    uint16_t overruns;      // outputs not ready at, or replaced before, the next PWM boundary
+    uint16_t saturated;     // steps with output clamped to 0 or 100%
+    uint16_t cycles_last;   // duration of the last step
+    uint16_t cycles_max;
+    uint16_t jitter;        // saturates at 0xffff
+    uint32_t interval;      // last time between iteration starts
+    uint16_t sample;        // last measurement
+    uint16_t output;        // last output, 0..CTRL_OUT_MAX
+    uint32_t elapsed;       // time since ctrl_clear_stats(), taken by ctrl_read_stats()
+} ctrl_stats_t;
+
+#define CTRL_STATS_SIZE     (24)    // bytes written by ctrl_read_stats()
+#define CTRL_PARAMS_SIZE    (8)     // bytes written by ctrl_get_params()
+
+/**
+ * @brief Enable PWM boundary interrupt, start in CTRL_OPEN
+ * @param duty - duty in TA0CCR2 at start
+ */
+extern void ctrl_init(uint16_t duty);
+
+/**
+ * @brief Change mode
+ * @param mode - CTRL_OPEN or CTRL_PID
+ *
+ * Integrator starts from the last output, so the switch is bumpless.
+ */
+extern void ctrl_set_mode(uint8_t mode);
+
+/**
+ * @brief Current mode
+ */
+extern uint8_t ctrl_get_mode(void);
+
+/**
+ * @brief Set setpoint and gains
+ * @param setpoint - ADC counts, 0..CTRL_SETPOINT_MAX
+ * @param kp, ki, kd - Q12 gains, 0..CTRL_GAIN_MAX
+ */
+extern void ctrl_set_params(uint16_t setpoint, uint16_t kp, uint16_t ki, uint16_t kd);
+
+/**
+ * @brief Current setpoint and gains
+ * @param dst - CTRL_PARAMS_SIZE bytes, setpoint, kp, ki, kd, little endian
+ * @return number of bytes written
+ */
+extern uint8_t ctrl_get_params(uint8_t *dst);
+
+/**
+ * @brief One controller iteration, called from ADC12 ISR
+ * @param sample - conversion result
+ * @param period - PWM period in ACLK cycles (TA0CCR0 + 1)
+ * @return duty in ACLK cycles, latched at the next PWM boundary
+ */
+extern uint16_t ctrl_step(uint16_t sample, uint16_t period);
+
+/**
+ * @brief Latch duty at the next PWM boundary instead of the pending output
+ * @param duty - duty in ACLK cycles
+ */
+extern void ctrl_latch(uint16_t duty);
+
+/**
+ * @brief Take a snapshot of stats block
+ * @param dst - CTRL_STATS_SIZE bytes
+ * @return number of bytes written
+ *
+ * Fields in the order of ctrl_stats_t, little endian.
+ */
+extern uint8_t ctrl_read_stats(uint8_t *dst);
+
+/**
+ * @brief Clear all stats
+ */
+extern void ctrl_clear_stats(void);
+
+#endif /* CTRL_H_ */
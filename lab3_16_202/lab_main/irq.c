@@ -0,0 +1,198 @@
+/**
+ * @file irq.c
+ * @brief Interrupt nesting/priority policy
+ *
+ * @date 19.10.2026.
+ * @author  Andrea Ciric (andreaciric23@gmail.com)
+ *
+ * @version [1.0 - 10/2026] Initial version for MSP430F5529
+ *
+ */
+
+#include <msp430.h>
+#include <stdint.h>
+#include "irq.h"
+
+volatile irq_stats_t irq_stats;
+
+static volatile uint8_t depth = 0;          // number of nested ISRs running with GIE set
+
+/**
+ * Priority and nesting settings indexed by IRQ_SRC_x
+ */
+static const uint8_t src_prio[IRQ_SRC_COUNT] = {
+        IRQ_PRIO_UART,
+        IRQ_PRIO_ADC12,
+        IRQ_PRIO_TICK,
+        IRQ_PRIO_BUTTON
+};
+
+static const uint8_t src_nest[IRQ_SRC_COUNT] = {
+        IRQ_NEST_UART,
+        IRQ_NEST_ADC12,
+        IRQ_NEST_TICK,
+        IRQ_NEST_BUTTON
+};
+
+/**
+ * @brief Clear IE bits of a source
+ * @return 1 if source was enabled
+ */
+static uint8_t src_mask(uint8_t src)
+{
+    switch (src)
+    {
+    case IRQ_SRC_UART:
+        if ((UCA1IE & (UCRXIE | UCTXIE)) == 0)
+            return 0;
+        UCA1IE &= ~(UCRXIE | UCTXIE);
+        return 1;
+    case IRQ_SRC_ADC12:
+        if ((ADC12IE & ADC12IE0) == 0)
+            return 0;
+        ADC12IE &= ~ADC12IE0;
+        return 1;
+    case IRQ_SRC_TICK:
+        if ((TA1CCTL0 & CCIE) == 0)
+            return 0;
+        TA1CCTL0 &= ~CCIE;
+        return 1;
+    case IRQ_SRC_BUTTON:
+        if ((P1IE & BIT4) == 0)
+            return 0;
+        P1IE &= ~BIT4;
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Set IE bits of a source masked by src_mask()
+ */
+static void src_unmask(uint8_t src)
+{
+    switch (src)
+    {
+    case IRQ_SRC_UART:
+        UCA1IE |= UCRXIE | UCTXIE;
+        break;
+    case IRQ_SRC_ADC12:
+        ADC12IE |= ADC12IE0;
+        break;
+    case IRQ_SRC_TICK:
+        TA1CCTL0 |= CCIE;
+        break;
+    case IRQ_SRC_BUTTON:
+        P1IE |= BIT4;
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Remember the longest time source kept GIE cleared
+ */
+static void account(uint8_t src, uint16_t entry)
+{
+    uint16_t blocked = irq_now() - entry;
+
+    if (blocked > irq_stats.blocked_max[src])
+        irq_stats.blocked_max[src] = blocked;
+}
+
+void irq_init(void)
+{
+    TA2CTL = TASSEL__SMCLK | MC_2 | TACLR;  // SMCLK, continuous mode
+
+    irq_clear_stats();
+}
+
+void irq_clear_stats(void)
+{
+    uint8_t i;
+    uint16_t state = __get_interrupt_state();
+
+    __disable_interrupt();
+    for (i = 0; i < IRQ_SRC_COUNT; i++)
+        irq_stats.blocked_max[i] = 0;
+    irq_stats.preempted = 0;
+    __set_interrupt_state(state);
+}
+
+void irq_enter(irq_ctx_t *ctx, uint8_t src)
+{
+    uint8_t i;
+
+    ctx->src = src;
+    ctx->masked = 0;
+
+    if (depth != 0)
+        irq_stats.preempted++;
+
+    if (src_nest[src] == 0)
+        return;                             // runs to the end with GIE cleared
+
+    for (i = 0; i < IRQ_SRC_COUNT; i++)
+    {
+        if ((src_prio[i] <= src_prio[src]) && (src_mask(i) != 0))
+            ctx->masked |= 1 << i;
+    }
+
+    depth++;
+    account(src, ctx->entry);
+    __enable_interrupt();
+}
+
+void irq_exit(irq_ctx_t *ctx)
+{
+    uint8_t i;
+
+    if (src_nest[ctx->src] == 0)
+    {
+        account(ctx->src, ctx->entry);
+        return;
+    }
+
+    __disable_interrupt();
+    depth--;
+    for (i = 0; i < IRQ_SRC_COUNT; i++)
+    {
+        if ((ctx->masked & (1 << i)) != 0)
+            src_unmask(i);
+    }
+}
+
+void irq_unmask(irq_ctx_t *ctx, uint8_t src)
+{
+    uint16_t state = __get_interrupt_state();
+
+    __disable_interrupt();
+    if ((src_nest[ctx->src] != 0) && (src_prio[src] <= src_prio[ctx->src]))
+        ctx->masked |= 1 << src;    // irq_exit() enables it
+    else
+        src_unmask(src);
+    __set_interrupt_state(state);
+}
+
+uint8_t irq_read_stats(uint8_t *dst)
+{
+    irq_stats_t s;
+    uint8_t i;
+    uint16_t state = __get_interrupt_state();
+
+    __disable_interrupt();          // take consistent snapshot
+    s = irq_stats;
+    __set_interrupt_state(state);
+
+    for (i = 0; i < IRQ_SRC_COUNT; i++)
+    {
+        *dst++ = s.blocked_max[i];
+        *dst++ = s.blocked_max[i] >> 8;
+    }
+    *dst++ = s.preempted;
+    *dst = s.preempted >> 8;
+
+    return IRQ_STATS_SIZE;
+}
@@ -0,0 +1,159 @@
+/**
+ * @file irq.h
+ * @brief Interrupt nesting/priority policy
+ *
+ * MSP430 clears GIE on ISR entry, so a long ISR delays every other
+ * request, including UART RX. An ISR that is allowed to nest calls
+ * irq_enter() after acknowledging its source. irq_enter() masks (clears
+ * IE bits of) all sources with priority lower than or equal to its own
+ * and sets GIE, so of the policy sources only those with higher
+ * priority can preempt it. irq_exit() clears GIE and restores the masked
+ * sources.
+ *
+ * Not every ISR is under the policy. The PWM boundary ISR (ctrl.c), the
+ * TA2 overflow ISR (cap.c) and the CTS ISR (uart.c) are short, never
+ * nest and can preempt any nested ISR. Critical sections in the main
+ * loop (rec_write(), stats snapshots, MPY32 access) also run with GIE
+ * cleared. None of these are measured.
+ *
+ * Time with GIE cleared is measured on TA2, which runs on SMCLK in
+ * continuous mode, and the worst case is kept per policy source. The
+ * largest blocked time of any other source plus the UART ISR time is
+ * therefore only a lower bound of UART RX latency; the unmeasured
+ * ISRs and critical sections above add to it. It has to stay well below
+ * one character time (~1.04ms, ~8330 SMCLK cycles at 9600 bps).
+ *
+ * Stack budget (--stack_size in Debug/makefile, 20bit return addresses
+ * and PUSHM.A take 4 bytes each): deepest main loop chain, a command
+ * handler under the dispatcher, ~80 bytes, plus ADC12 ISR nested over
+ * it with ctrl_step() and pid() ~70 bytes, plus one non nesting ISR on
+ * top (UART, PWM boundary, TA2 overflow or CTS) ~40 bytes, is ~190
+ * bytes worst case. TICK and BUTTON can not stack on ADC12, they have
+ * the same priority. Stack is 320 bytes, keep the margin when an ISR or
+ * a command handler gets more locals.
+ *
+ * Flash erase (persist.h) holds the CPU for ~32ms, outside of any ISR.
+ * PC is held off around it with uart_hold(), which needs RTS/CTS flow
+ * control; without it bytes sent during an erase are lost.
+ *
+ * @date 19.10.2026.
+ * @author  Andrea Ciric (andreaciric23@gmail.com)
+ *
+ * @version [1.0 - 10/2026] Initial version for MSP430F5529
+ *
+ */
+
+#ifndef IRQ_H_
+#define IRQ_H_
+
+#include <msp430.h>
+#include <stdint.h>
+
+/**
+ * @brief Interrupt sources handled by the policy
+ */
+#define IRQ_SRC_UART        (0)
+#define IRQ_SRC_ADC12       (1)
+#define IRQ_SRC_TICK        (2)     // TA1CCR0 5ms tick
+#define IRQ_SRC_BUTTON      (3)     // P1.4
+#define IRQ_SRC_COUNT       (4)
+
+/**
+ * @brief Software priority of each source, higher value wins
+ */
+#define IRQ_PRIO_UART       (3)     // UART RX must never be starved
+#define IRQ_PRIO_ADC12      (1)
+#define IRQ_PRIO_TICK       (1)
+#define IRQ_PRIO_BUTTON     (1)
+
+/**
+ * @brief Sources that re-enable GIE after acknowledging the request
+ */
+#define IRQ_NEST_UART       (0)
+#define IRQ_NEST_ADC12      (1)
+#define IRQ_NEST_TICK       (1)
+#define IRQ_NEST_BUTTON     (0)
+
+/**
+ * @brief Context of one ISR, kept on the ISR stack
+ */
+typedef struct
+{
+    uint16_t entry;         // TA2R at ISR entry
+    uint16_t masked;        // bit n set => source n was masked by this ISR
+    uint8_t src;            // IRQ_SRC_x
+} irq_ctx_t;
+
+/**
+ * @brief Interrupt statistics
+ *
+ * Times are in SMCLK cycles and do not include the 6 cycles
+ * of interrupt acceptance and ISR prologue.
+ */
+typedef struct
+{
+    uint16_t blocked_max[IRQ_SRC_COUNT];    // longest time with GIE cleared
+    uint16_t preempted;                     // UART ISR ran while another ISR was nested
+} irq_stats_t;
+
+extern volatile irq_stats_t irq_stats;
+
+#define IRQ_STATS_SIZE      (IRQ_SRC_COUNT*2 + 2)   // bytes written by irq_read_stats()
+
+/**
+ * @brief SMCLK frequency, DCO is locked to it by FLL in main.c
+ *
+ * 244 x 32768Hz, TA2 wraps every ~8.2ms.
+ */
+#define SMCLK_HZ        (7995392UL)
+
+/**
+ * @brief Current TA2 timestamp in SMCLK cycles
+ */
+#define irq_now()       (TA2R)
+
+/**
+ * @brief Start TA2 as free running SMCLK timebase and clear stats
+ */
+extern void irq_init(void);
+
+/**
+ * @brief Called from ISR after its request is acknowledged
+ * @param ctx - ISR context, ctx->entry must be set to irq_now()
+ *              as the first statement of the ISR
+ * @param src - source of the ISR (IRQ_SRC_x)
+ */
+extern void irq_enter(irq_ctx_t *ctx, uint8_t src);
+
+/**
+ * @brief Called from ISR just before it returns
+ * @param ctx - ISR context filled by irq_enter()
+ */
+extern void irq_exit(irq_ctx_t *ctx);
+
+/**
+ * @brief Enable a source from inside an ISR
+ * @param ctx - context of the running ISR
+ * @param src - source to enable (IRQ_SRC_x)
+ *
+ * If the running ISR nests and src would be masked by it, src is only
+ * marked in ctx and enabled by irq_exit(), so it can not preempt a
+ * source with the same or higher priority.
+ */
+extern void irq_unmask(irq_ctx_t *ctx, uint8_t src);
+
+/**
+ * @brief Take a consistent snapshot of stats block
+ * @param dst - IRQ_STATS_SIZE bytes
+ * @return number of bytes written
+ *
+ * blocked_max for every source and preempted, all 16bit little endian.
+ */
+extern uint8_t irq_read_stats(uint8_t *dst);
+
+/**
+ * @brief Clear all stats
+ */
+extern void irq_clear_stats(void);
+
+#endif /* IRQ_H_ */
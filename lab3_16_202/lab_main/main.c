@@ -4,31 +4,62 @@
  *
  * Timer B0 periodically (16Hz) triggers the conversion
  * on channel A0 of ADC12, which is connected to a potentiometer.
- * 8 greater bits from 12 bits of the conversion result are sent
- * using UART to PC everytime PC sends 's' (0x73) and at the same
- * time defining the duty cycle of PWM on TA0CCR2 OUT. On every 's'
- * PWM duty cycle gets inverted.
+ * Trigger source can be changed on the run (see acq.h).
+ * Conversion result goes through the control stage (see ctrl.h), which
+ * defines the duty cycle of PWM on TA0CCR2 OUT, unless duty is set by
+ * PC. New duty is latched at the PWM period boundary.
+ *
+ * PC controls the board with binary commands (see cmd.h):
+ *  0x00 ping        any     echo arguments
+ *  0x01 display     u8      value 0..99 on 7seg displays
+ *  0x02 pwm duty    u16     duty in ACLK cycles, PWM_DUTY_POT - duty follows pot
+ *  0x03 pwm period  u16     period in ACLK cycles, >= 2, >= ACQ_TA0_PERIOD_MIN with TA0 trigger
+ *  0x04 polarity    u8      0 - Reset/Set, 1 - Set/Reset
+ *  0x05 adc read    -       reply u16 last conversion result
+ *  0x06 trigger     u8      ACQ_TRIG_x
+ *  0x07 adc rate    u16     TB0 trigger period in ACLK cycles
+ *  0x08 burst arm   u8 pre, u8 post, u8 event (ACQ_EVT_x), u16 level
+ *  0x09 event       -       software trigger and event
+ *  0x0a burst read  u8 pos  reply state, pre, post, up to BURST_CHUNK samples
+ *  0x0b uart stats  -       reply uart_read_stats()
+ *  0x0c irq stats   -       reply irq_read_stats()
+ *  0x0d cmd stats   -       reply cmd_read_stats()
+ *  0x0e clear stats -       UART, interrupt and command stats
+ *  0x0f flow        u8      UART_FLOW_NONE or UART_FLOW_RTSCTS
+ *  0x10 capture     -       reply cap_read(), signal on P2.5
+ *  0x11 ctrl mode   u8      CTRL_OPEN - duty follows A0, CTRL_PID - also selects ACQ_TRIG_TA0
+ *  0x12 ctrl params u16 setpoint, u16 kp, u16 ki, u16 kd (Q12)
+ *  0x13 ctrl stats  -       reply ctrl_read_stats()
+ *  0x14 persist     u8      1 - suspend flash writes (e.g. while benchmarking), 0 - resume
+ * Duty, period, trigger, ctrl mode and ctrl params reply the current
+ * value when sent without argument, so PC can restore them later.
+ * PWM, trigger source and displayed value are restored from info
+ * flash after reset.
  *
  * @date 15.05.2021.
  * @author  Andrea Ciric (andreaciric23@gmail.com)
  *
  * @version [1.0 - 05/2021] Initial version for MSP430F5529
+ * @version [1.1 - 10/2026] Buffered UART with error stats and flow control
+ * @version [1.2 - 10/2026] ADC12 ISR nests, so UART RX can preempt it
+ * @version [1.3 - 10/2026] Runtime trigger source and burst capture
+ * @version [1.4 - 10/2026] State kept in info flash
+ * @version [1.5 - 10/2026] Binary commands instead of single characters, 7seg display
+ * @version [1.6 - 10/2026] SMCLK at 8MHz, edge capture on TA2.2
+ * @version [1.7 - 10/2026] PID control stage, duty latched at PWM boundary
+ * @version [1.8 - 10/2026] Settings read back, flash writes can be suspended
  *
  */
-#include <msp430.h> 
+#include <msp430.h>
 #include <stdint.h>
-
-#define BR9600      (3)         //ACLK
-#define BRS9600      (UCBRS_3)  //ACLK
-
-/**
- * @brief Timer period for ADC12 conversion triggering
- *
- * Timer is clocked by ACLK (32768Hz).
- * No divider is set.
- * We want 16Hz frequency, so use 2048 for CCR1
- */
-#define CONV_PERIOD        (2048)  /* ~62.5 ms */
+#include "uart.h"
+#include "irq.h"
+#include "acq.h"
+#include "persist.h"
+#include "cmd.h"
+#include "writeLed.h"
+#include "cap.h"
+#include "ctrl.h"
 
 /*
  * Timer is clocked by ACLK (32768Hz)
@@ -36,6 +67,8 @@
  */
 #define PWM_PERIOD      (32768)  /* 1s */
 
+#define PWM_DUTY_POT    (0xffff)    // duty argument that gives duty back to pot
+
 /**
  * @brief Timer period
  *
@@ -44,99 +77,499 @@
  */
 #define TIMER_PERIOD        (163)  /* ~5ms (4.97ms) */
 
+#define BURST_CHUNK         (8)     // samples in one burst read reply
+
+/**
+ * @brief Runtime state kept in info flash
+ */
+typedef struct
+{
+    uint16_t duty;          // TA0CCR2
+    uint16_t period;        // TA0CCR0 + 1
+    uint8_t polarity;       // 0 - Reset/Set, 1 - Set/Reset
+    uint8_t trigger;        // ACQ_TRIG_x
+    uint8_t display;        // 0..99
+    uint8_t manual;         // 1 - duty set by PC
+} state_t;
 
 volatile unsigned int ad_result = 0;        // variable where conversion result is placed
 volatile uint16_t dutyclc = 0;              // variable where duty cycle is placed
-volatile uint8_t temp = 0;                  // variable where data received in Rx is saved
+
+static volatile uint16_t pwm_period = PWM_PERIOD;
+static volatile uint8_t duty_manual = 0;    // 1 - duty set by PC, pot is ignored
+static volatile uint8_t disp2, disp1;       // digits used for display (order: [disp2 disp1])
+
+static state_t saved;                       // state last passed to persist_store()
 
 /**
- * @brief Main function
+ * @brief Pass state to persistence module if it has changed
  *
- * Peripheral initialization. USCI_A1 is used in UART mode
- * for transfer of ADC12 conversion result.
+ * Duty changes smaller than 1/64 of period are ADC noise and
+ * would wear the flash.
  */
-int main(void)
+static void check_state(void)
 {
-    WDTCTL = WDTPW | WDTHOLD;       // Stop watchdog timer
+    state_t now;
+    uint16_t diff;
+
+    now.duty = dutyclc;
+    now.period = pwm_period;
+    now.polarity = ((TA0CCTL2 & OUTMOD_7) == OUTMOD_3) ? 1 : 0;
+    now.trigger = acq_get_trigger();
+    now.display = disp2 * 10 + disp1;
+    now.manual = duty_manual;
+
+    diff = (now.duty > saved.duty) ? (now.duty - saved.duty) : (saved.duty - now.duty);
+    if ((diff < (now.period >> 6)) && (now.period == saved.period)
+            && (now.polarity == saved.polarity) && (now.trigger == saved.trigger)
+            && (now.display == saved.display) && (now.manual == saved.manual))
+        return;
+
+    saved = now;
+    persist_store(&saved);
+}
+
+static uint8_t cmd_ping(const uint8_t *arg, uint8_t len, uint8_t *reply, uint8_t *reply_len)
+{
+    uint8_t i;
+
+    for (i = 0; i < len; i++)
+        reply[i] = arg[i];
+    *reply_len = len;
+    return CMD_OK;
+}
+
+static uint8_t cmd_display(const uint8_t *arg, uint8_t len, uint8_t *reply, uint8_t *reply_len)
+{
+    if (arg[0] > 99)
+        return CMD_ERR_ARG;
+    disp2 = arg[0] / 10;
+    disp1 = arg[0] % 10;
+    return CMD_OK;
+}
+
+static uint8_t cmd_pwm_duty(const uint8_t *arg, uint8_t len, uint8_t *reply, uint8_t *reply_len)
+{
+    uint16_t duty;
+
+    if (len == 0)
+    {
+        duty = (duty_manual != 0) ? dutyclc : PWM_DUTY_POT;
+        CMD_PUT16(reply, duty);
+        *reply_len = 2;
+        return CMD_OK;
+    }
+    if (len != 2)
+        return CMD_ERR_LEN;
+
+    duty = CMD_GET16(arg);
+    if (duty == PWM_DUTY_POT)
+    {
+        duty_manual = 0;        // next conversion sets the duty
+        return CMD_OK;
+    }
+    if (duty > pwm_period)
+        return CMD_ERR_ARG;
+
+    duty_manual = 1;
+    dutyclc = duty;
+    ctrl_latch(duty);           // change duty cycle at the next period, timer stop not needed
+    return CMD_OK;
+}
+
+static uint8_t cmd_pwm_period(const uint8_t *arg, uint8_t len, uint8_t *reply, uint8_t *reply_len)
+{
+    uint16_t period = pwm_period;
+    uint16_t state;
+
+    if (len == 0)
+    {
+        CMD_PUT16(reply, period);
+        *reply_len = 2;
+        return CMD_OK;
+    }
+    if (len != 2)
+        return CMD_ERR_LEN;
+
+    period = CMD_GET16(arg);
+    if (period < 2)
+        return CMD_ERR_ARG;
+    if ((acq_get_trigger() == ACQ_TRIG_TA0) && (period < ACQ_TA0_PERIOD_MIN))
+        return CMD_ERR_STATE;   // TA0.1 would give no edge, ADC would stop
+
+    state = __get_interrupt_state();
+    __disable_interrupt();      // ADC ISR uses period and duty
+    pwm_period = period;
+    if (dutyclc > period)
+        dutyclc = period;
+    TA0CCR2 = dutyclc;
+    ctrl_latch(dutyclc);        // pending output was scaled to the old period
+    TA0CCR0 = period - 1;
+    if (TA0R >= TA0CCR0)        // already past new CCR0, would count up to 0xffff
+        TA0CTL |= TACLR;
+    __set_interrupt_state(state);
+    return CMD_OK;
+}
+
+static uint8_t cmd_polarity(const uint8_t *arg, uint8_t len, uint8_t *reply, uint8_t *reply_len)
+{
+    if (arg[0] > 1)
+        return CMD_ERR_ARG;
+    // change TA0CCTL2 output mode on the run, timer stop not needed
+    /* A safe method for switching between output modes is to
+        use output mode 7 as a transition state => as we are already operating
+        with mode 7 it is fine (S/R -> 011b, R/S -> 111b)*/
+    TA0CCTL2 = (TA0CCTL2 & ~OUTMOD_7) | (arg[0] ? OUTMOD_3 : OUTMOD_7);
+    return CMD_OK;
+}
+
+static uint8_t cmd_adc_read(const uint8_t *arg, uint8_t len, uint8_t *reply, uint8_t *reply_len)
+{
+    uint16_t result = ad_result;
+
+    CMD_PUT16(reply, result);
+    *reply_len = 2;
+    return CMD_OK;
+}
+
+static uint8_t cmd_trigger(const uint8_t *arg, uint8_t len, uint8_t *reply, uint8_t *reply_len)
+{
+    if (len == 0)
+    {
+        reply[0] = acq_get_trigger();
+        *reply_len = 1;
+        return CMD_OK;
+    }
+    if (len != 1)
+        return CMD_ERR_LEN;
+
+    if (arg[0] >= ACQ_TRIG_COUNT)
+        return CMD_ERR_ARG;
+    if ((ctrl_get_mode() == CTRL_PID) && (arg[0] != ACQ_TRIG_TA0))
+        return CMD_ERR_STATE;   // closed loop runs only in sync with PWM
+    if ((arg[0] == ACQ_TRIG_TA0) && (pwm_period < ACQ_TA0_PERIOD_MIN))
+        return CMD_ERR_STATE;
+    acq_set_trigger(arg[0]);
+    return CMD_OK;
+}
+
+static uint8_t cmd_adc_rate(const uint8_t *arg, uint8_t len, uint8_t *reply, uint8_t *reply_len)
+{
+    uint16_t period = CMD_GET16(arg);
+
+    if ((period < 4) || (period == 0xffff))
+        return CMD_ERR_ARG;
+    acq_set_period(period);
+    return CMD_OK;
+}
+
+static uint8_t cmd_burst_arm(const uint8_t *arg, uint8_t len, uint8_t *reply, uint8_t *reply_len)
+{
+    uint16_t level = CMD_GET16(arg + 3);
+
+    if ((arg[2] > ACQ_EVT_THRESHOLD) || (level > 0xfff))
+        return CMD_ERR_ARG;
+    acq_arm(arg[0], arg[1], arg[2], level);
+    return CMD_OK;
+}
+
+static uint8_t cmd_event(const uint8_t *arg, uint8_t len, uint8_t *reply, uint8_t *reply_len)
+{
+    acq_convert();
+    acq_event(ACQ_EVT_SOFTWARE);
+    return CMD_OK;
+}
+
+static uint8_t cmd_burst_read(const uint8_t *arg, uint8_t len, uint8_t *reply, uint8_t *reply_len)
+{
+    uint16_t samples[BURST_CHUNK];
+    uint8_t i, n = 0;
+
+    reply[0] = acq_state();
+    reply[1] = 0;
+    reply[2] = 0;
+    if (reply[0] == ACQ_DONE)
+    {
+        acq_window(&reply[1], &reply[2]);
+        n = acq_read(arg[0], samples, BURST_CHUNK);
+    }
+
+    for (i = 0; i < n; i++)
+        CMD_PUT16(reply + 3 + 2*i, samples[i]);
+    *reply_len = 3 + 2*n;
+    return CMD_OK;
+}
 
-    // Initialize UART
-    P4SEL |= BIT4 | BIT5;           // enable P4.4 and P4.5 for UART
+static uint8_t cmd_uart_stats(const uint8_t *arg, uint8_t len, uint8_t *reply, uint8_t *reply_len)
+{
+    *reply_len = uart_read_stats(reply);
+    return CMD_OK;
+}
+
+static uint8_t cmd_irq_stats(const uint8_t *arg, uint8_t len, uint8_t *reply, uint8_t *reply_len)
+{
+    *reply_len = irq_read_stats(reply);
+    return CMD_OK;
+}
+
+static uint8_t cmd_cmd_stats(const uint8_t *arg, uint8_t len, uint8_t *reply, uint8_t *reply_len)
+{
+    *reply_len = cmd_read_stats(reply);
+    return CMD_OK;
+}
+
+static uint8_t cmd_clear_stats_all(const uint8_t *arg, uint8_t len, uint8_t *reply, uint8_t *reply_len)
+{
+    uart_clear_stats();
+    irq_clear_stats();
+    cmd_clear_stats();
+    ctrl_clear_stats();
+    return CMD_OK;
+}
+
+static uint8_t cmd_capture(const uint8_t *arg, uint8_t len, uint8_t *reply, uint8_t *reply_len)
+{
+    *reply_len = cap_read(reply);
+    return CMD_OK;
+}
+
+static uint8_t cmd_ctrl_mode(const uint8_t *arg, uint8_t len, uint8_t *reply, uint8_t *reply_len)
+{
+    if (len == 0)
+    {
+        reply[0] = ctrl_get_mode();
+        *reply_len = 1;
+        return CMD_OK;
+    }
+    if (len != 1)
+        return CMD_ERR_LEN;
+
+    if (arg[0] > CTRL_PID)
+        return CMD_ERR_ARG;
+    if ((arg[0] == CTRL_PID) && (pwm_period < ACQ_TA0_PERIOD_MIN))
+        return CMD_ERR_STATE;   // needs ACQ_TRIG_TA0
+    if (arg[0] == CTRL_PID)
+    {
+        acq_set_trigger(ACQ_TRIG_TA0);  // one conversion at the start of every PWM period
+        duty_manual = 0;
+    }
+    ctrl_set_mode(arg[0]);
+    return CMD_OK;
+}
+
+static uint8_t cmd_ctrl_params(const uint8_t *arg, uint8_t len, uint8_t *reply, uint8_t *reply_len)
+{
+    uint16_t setpoint, kp, ki, kd;
+
+    if (len == 0)
+    {
+        *reply_len = ctrl_get_params(reply);
+        return CMD_OK;
+    }
+    if (len != CTRL_PARAMS_SIZE)
+        return CMD_ERR_LEN;
+
+    setpoint = CMD_GET16(arg);
+    kp = CMD_GET16(arg + 2);
+    ki = CMD_GET16(arg + 4);
+    kd = CMD_GET16(arg + 6);
+    if ((setpoint > CTRL_SETPOINT_MAX) || (kp > CTRL_GAIN_MAX)
+            || (ki > CTRL_GAIN_MAX) || (kd > CTRL_GAIN_MAX))
+        return CMD_ERR_ARG;
+    ctrl_set_params(setpoint, kp, ki, kd);
+    return CMD_OK;
+}
+
+static uint8_t cmd_ctrl_stats(const uint8_t *arg, uint8_t len, uint8_t *reply, uint8_t *reply_len)
+{
+    *reply_len = ctrl_read_stats(reply);
+    return CMD_OK;
+}
+
+static uint8_t cmd_persist(const uint8_t *arg, uint8_t len, uint8_t *reply, uint8_t *reply_len)
+{
+    if (arg[0] > 1)
+        return CMD_ERR_ARG;
+    persist_suspend(arg[0]);
+    return CMD_OK;
+}
+
+static uint8_t cmd_flow(const uint8_t *arg, uint8_t len, uint8_t *reply, uint8_t *reply_len)
+{
+    // XON/XOFF would take 0x11/0x13 out of binary frames
+    if ((arg[0] > UART_FLOW_RTSCTS) || (arg[0] == UART_FLOW_XONXOFF))
+        return CMD_ERR_ARG;
+    uart_set_flow(arg[0]);
+    return CMD_OK;
+}
+
+/**
+ * @brief Command jump table, indexed by opcode
+ */
+static const cmd_entry_t cmd_table[] = {
+    /* handler              arg len         reply max */
+    { cmd_ping,             CMD_ANY_LEN,    CMD_DATA_MAX },         // 0x00
+    { cmd_display,          1,              0 },                    // 0x01
+    { cmd_pwm_duty,         CMD_ANY_LEN,    2 },                    // 0x02
+    { cmd_pwm_period,       CMD_ANY_LEN,    2 },                    // 0x03
+    { cmd_polarity,         1,              0 },                    // 0x04
+    { cmd_adc_read,         0,              2 },                    // 0x05
+    { cmd_trigger,          CMD_ANY_LEN,    1 },                    // 0x06
+    { cmd_adc_rate,         2,              0 },                    // 0x07
+    { cmd_burst_arm,        5,              0 },                    // 0x08
+    { cmd_event,            0,              0 },                    // 0x09
+    { cmd_burst_read,       1,              3 + 2*BURST_CHUNK },    // 0x0a
+    { cmd_uart_stats,       0,              UART_STATS_SIZE },      // 0x0b
+    { cmd_irq_stats,        0,              IRQ_STATS_SIZE },       // 0x0c
+    { cmd_cmd_stats,        0,              CMD_STATS_SIZE },       // 0x0d
+    { cmd_clear_stats_all,  0,              0 },                    // 0x0e
+    { cmd_flow,             1,              0 },                    // 0x0f
+    { cmd_capture,          0,              CAP_RESULT_SIZE },      // 0x10
+    { cmd_ctrl_mode,        CMD_ANY_LEN,    1 },                    // 0x11
+    { cmd_ctrl_params,      CMD_ANY_LEN,    CTRL_PARAMS_SIZE },     // 0x12
+    { cmd_ctrl_stats,       0,              CTRL_STATS_SIZE },      // 0x13
+    { cmd_persist,          1,              0 },                    // 0x14
+};
 
-    UCA1CTL1 |= UCSWRST;            // set software reset
+/**
+ * @brief Lock DCO to SMCLK_HZ, MCLK = SMCLK = DCOCLKDIV
+ *
+ * FLL reference is REFO, ACLK is not changed. 8MHz does not need
+ * higher core voltage.
+ */
+static void clock_init(void)
+{
+    UCSCTL3 = SELREF_2;                         // FLL reference is REFO
+    __bis_SR_register(SCG0);                    // disable FLL while it is set up
+    UCSCTL0 = 0;                                // lowest DCOx and MODx
+    UCSCTL1 = DCORSEL_5;                        // DCO range for 16MHz
+    UCSCTL2 = FLLD_1 | (SMCLK_HZ / 32768 - 1);  // DCOCLK = 2 x DCOCLKDIV = 2 x 244 x 32768Hz
+    __bic_SR_register(SCG0);
 
-    UCA1CTL0 = 0;                   // no parity, 8bit, 1 stop bit
-    UCA1CTL1 |= UCSSEL__ACLK;       // use ACLK = 32 768 Hz
-    UCA1BRW = BR9600;               // BR = 3
-    UCA1MCTL |= BRS9600 + UCBRF_0;   // BRS = 3 for 9600 bps
+    // worst case settling time is 32 x 32 x f_MCLK / f_FLL_ref MCLK cycles
+    __delay_cycles(250000);
+    do
+    {
+        UCSCTL7 &= ~DCOFFG;
+        SFRIFG1 &= ~OFIFG;
+    } while ((UCSCTL7 & DCOFFG) != 0);
+}
 
-    UCA1CTL1 &= ~UCSWRST;           // release software reset
+/**
+ * @brief Main function
+ *
+ * Peripheral initialization. USCI_A1 is used in UART mode
+ * for commands from PC.
+ */
+int main(void)
+{
+    WDTCTL = WDTPW | WDTHOLD;       // Stop watchdog timer
 
-    UCA1IE |= UCRXIE | UCTXIE;      // enable RX and TX interrupt
+    clock_init();
+    irq_init();                     // TA2 timebase for ISR latency measurement
+    cap_init();                     // TA2.2 capture, 32bit time
 
+    // Initialize UART, 9600 bps, no flow control until PC asks for it
+    uart_init(UART_FLOW_NONE);
+    cmd_init(cmd_table, sizeof(cmd_table) / sizeof(cmd_table[0]));
 
-    /* REF module */
-    REFCTL0 &= ~REFMSTR;        // ref system controlled by legacy control bits inside ADC12_A
+    // restore state saved before reset
+    if ((persist_init(&saved) == 0) || (saved.period < 2) || (saved.duty > saved.period)
+            || (saved.trigger >= ACQ_TRIG_COUNT) || (saved.display > 99) || (saved.manual > 1)
+            || ((saved.trigger == ACQ_TRIG_TA0) && (saved.period < ACQ_TA0_PERIOD_MIN)))
+    {
+        saved.duty = 0;                 // initial state is no pulse
+        saved.period = PWM_PERIOD;
+        saved.polarity = 0;
+        saved.trigger = ACQ_TRIG_TB0;   // triggered by TB0 at 16Hz
+        saved.display = 0;
+        saved.manual = 0;
+    }
+    dutyclc = saved.duty;
+    pwm_period = saved.period;
+    duty_manual = saved.manual;
+    disp2 = saved.display / 10;
+    disp1 = saved.display % 10;
 
-    /* ADC12_A channel A0 init */
-    P6SEL |= BIT0;              // set pin P6.0 as alternate function - A0 analog
-                                // this is pot2 potentiometer
-    ADC12CTL0 &= ~ADC12ENC;     // disable ADC before configuring
-    /* 32 cycles for sampling, ref voltage is set by ADC12_A, ADC ON */
-    ADC12CTL0 |= ADC12SHT0_3 + ADC12REF2_5V + ADC12ON;
-    ADC12CTL1 |= ADC12CSTARTADD_0 + ADC12SHS_2 + ADC12SHP + ADC12SSEL_0 + ADC12CONSEQ_2; // start address ADC12MEM0, timer starts conversion
-                                                                                         // single channel single conversion, MODCLK clock
-                                                                                         // SAMPCON sourced from the sampling timer
-    ADC12CTL2 |= ADC12RES_2;    // 12 bit conversion result
-    ADC12MCTL0 |= ADC12INCH_0;  // reference AVCC and AVSS, channel A0
+    // ADC12 on A0
+    acq_init(saved.trigger);
 
-    ADC12IE |= ADC12IE0;        // enable interrupt request for the ADC12IFG0 bit
-    //ADC12IFG &= ~ADC12IFG0;     // clear ADC12MEM0 interrupt flag
+    // sevenseg 1
+    P7DIR |= BIT0;              // set P7.0 as out (SEL1)
+    P7OUT |= BIT0;              // disable display 1
+    // sevenseg 2
+    P6DIR |= BIT4;              // set P6.4 as out (SEL2)
+    P6OUT |= BIT4;              // disable display 2
 
-    ADC12CTL0 |= ADC12ENC;      // enable ADC12
+    // a,b,c,d,e,f,g
+    P2DIR |= 0x48;              // configure P2.3 and P2.6 as out
+    P3DIR |= BIT7;              // configure P3.7 as out
+    P4DIR |= 0x09;              // configure P4.0 and P4.3 as out
+    P8DIR |= 0x06;              // configure P8.1 and P8.2 as out
 
-    /* initialize Timer B0 for ADC12 trigger */
-    // CBOUT CCR0 TB0 -> ADC12SHS2 this is internal, ports and pins not used (P5.6)
-    TB0CCR0 = (CONV_PERIOD/2  - 1);// f_OUT = 16 Hz, f_ACLK = 32768 Hz ID=1 => T_OUT = 2048.
-                                   // TOGGLE outmod => T_OUT = 2 * T_CCR0 =>
-                                   // T_CCR0 = T_OUT/2 = 1024 (TA0CCR0 = T_CCR0 - 1)
-    TB0CCTL0 |= OUTMOD_4;    // toggle mode
-    TB0CTL |= TBSSEL__ACLK + ID__1 + MC__UP;
+    // init TA1 as 5ms tick for display mux, button debounce, command timeout
+    // and flash write batching
+    TA1CCR0 = TIMER_PERIOD;         // set timer period in CCR0 register
+    TA1CCTL0 = CCIE;                // enable interrupt for TA1CCR0
+    TA1CTL = TASSEL__ACLK | MC__UP; //clock select and up mode
 
     /* init timerA0 with PWM out on LD2 through TA0 CCR2 */
 
-    TA0CCR0 = PWM_PERIOD - 1;       // init pwm period
+    TA0CCR0 = pwm_period - 1;       // init pwm period
     // timer is in compare mode with active OUT signa
-    TA0CCR2 = dutyclc;          // initial state is no pulse
-    TA0CCTL2 = OUTMOD_7;        // outmode is Reset/Set
-                                // CCR2 value defines the pulse width
+    TA0CCR2 = dutyclc;          // restored duty cycle
+    TA0CCTL2 = saved.polarity ? OUTMOD_3 : OUTMOD_7;   // outmode is Reset/Set or Set/Reset
+                                                       // CCR2 value defines the pulse width
     // init P1.3 pin as alternate function pin
     P1SEL |= BIT3;              // alternate function
     P1DIR |= BIT3;              // P1.3 is TA0.2 pin
     // activate timer
     TA0CTL = TASSEL__ACLK | MC__UP;
+    ctrl_init(dutyclc);         // later duty changes are latched at PWM boundary
 
 
     __enable_interrupt();       // GIE
 
     while(1){
+        cmd_service();
+        cap_service();
+
+        check_state();
+        // flash write holds CPU, do it while line is quiet and PC is held off
+        if ((persist_pending() != 0) && (uart_idle() != 0) && (uart_hold() != 0))
+        {
+            if (persist_service() != 0)
+                cap_restart();      // TA2 overflows were lost during erase
+            uart_release();
+        }
     }
 }
 
 /**
  * @brief ADC ISR
  *
- * On ADC12IFG0 save ADC12MEM0
+ * On ADC12IFG0 save ADC12MEM0. Reading ADC12MEM0 clears the request,
+ * after that UART may preempt the rest of the ISR.
  */
 void __attribute__ ((interrupt(ADC12_VECTOR))) ADC12ISR (void)
 {
+    irq_ctx_t ctx;
+
+    ctx.entry = irq_now();
+
     switch (ADC12IV)
     {
     case ADC12IV_ADC12IFG0:
-        // change TA0CCR2 duty cycle on the run, timer stop not needed
-
         ad_result = ADC12MEM0;
-        dutyclc = (ad_result & 0xfff) * (PWM_PERIOD/0xfff);
-        TA0CCR2 = dutyclc;
+        irq_enter(&ctx, IRQ_SRC_ADC12);
+
+        acq_sample(ad_result);
+
+        // next duty, latched at the PWM boundary, timer stop not needed
+        if (duty_manual == 0)
+            dutyclc = ctrl_step(ad_result, pwm_period);
+
+        irq_exit(&ctx);
         break;
     default:
         break;
@@ -144,28 +577,42 @@ void __attribute__ ((interrupt(ADC12_VECTOR))) ADC12ISR (void)
 }
 
 /**
- * @brief USCI UART ISR
+ * @brief TA1CCR0 ISR
+ *
+ * 5ms tick. Multiplexes the 7seg display, one digit per tick,
+ * debounces the button of the acquisition front end, times out
+ * incomplete commands and delays flash writes until state is stable.
  */
-void __attribute__ ((interrupt(USCI_A1_VECTOR))) UARTISR (void)
+void __attribute__ ((interrupt(TIMER1_A0_VECTOR))) CCR0ISR (void)
 {
-    switch (UCA1IV)
+    static uint8_t current_digit = 0;
+    irq_ctx_t ctx;
+
+    ctx.entry = irq_now();
+    irq_enter(&ctx, IRQ_SRC_TICK);
+
+    /* algorithm:
+     * - turn off previous display (SEL signal)
+     * - set a..g for current display
+     * - activate current display
+     */
+    if (current_digit == 1)
     {
-    case 0:
-        break;
-    case USCI_UCRXIFG:                      // on Rx interrupt flag do:
-        temp = UCA1RXBUF;                   // store Rx value when interrupt happens
-        if (temp == 0x73)                   // wait for 's' to be received
-        {
-            UCA1TXBUF = ad_result >> 4;
-            // change TA0CCTL2 output mode on the run, timer stop not needed
-            /* A safe method for switching between output modes is to
-                use output mode 7 as a transition state => as we are already operating
-                with mode 7 it is fine (S/R -> 011b, R/S -> 111b)*/
-            TA0CCTL2 ^= OUTMOD_4;           // 011 xor 100 -> 111 xor 100 -> 011...
-        }
-        break;
-    case USCI_UCTXIFG:                      // on Tx interrupt flag do:
-        /* UCTXIFG is automatically reset if a character is written to UCAxTXBUF. */
-        break;
+        P6OUT |= BIT4;          // turn off SEL2
+        WriteLed(disp2);        // define seg a..g
+        P7OUT &= ~BIT0;         // turn on SEL1
     }
+    else
+    {
+        P7OUT |= BIT0;
+        WriteLed(disp1);
+        P6OUT &= ~BIT4;
+    }
+    current_digit ^= 1;
+
+    acq_tick(&ctx);
+    cmd_tick();
+    persist_tick();
+
+    irq_exit(&ctx);
 }
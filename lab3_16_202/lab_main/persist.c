@@ -0,0 +1,261 @@
+/**
+ * @file persist.c
+ * @brief Wear levelled storage of runtime state in info flash
+ *
+ * Record layout (words): PERSIST_DATA_SIZE/2 words of data, then
+ * marker word (PERSIST_MAGIC << 8 | checksum). Marker is written last,
+ * so a record torn by reset is not valid. A slot is free only if all its
+ * words are erased (0xffff).
+ *
+ * @date 19.10.2026.
+ * @author  Andrea Ciric (andreaciric23@gmail.com)
+ *
+ * @version [1.0 - 10/2026] Initial version for MSP430F5529
+ *
+ */
+
+#include <msp430.h>
+#include <stdint.h>
+#include "persist.h"
+
+#define PERSIST_AREA    ((volatile uint16_t *)0x1800)   // INFOD, INFOC, INFOB
+#define PERSIST_MAGIC   (0x5a)
+
+#define SEG_WORDS       (64)                            // 128 byte segment
+#define SEG_COUNT       (3)
+#define DATA_WORDS      (PERSIST_DATA_SIZE / 2)
+#define REC_WORDS       (DATA_WORDS + 1)
+#define SEG_RECS        (SEG_WORDS / REC_WORDS)
+#define NO_SEG          (0xff)
+
+static uint8_t active = NO_SEG;             // segment records are appended to
+static uint8_t next_rec = 0;                // next free record in active segment
+static uint16_t written[DATA_WORDS];        // copy of the latest record
+static uint16_t pending[DATA_WORDS];        // state waiting to be written
+static volatile uint8_t dirty = 0;
+static volatile uint16_t quiet = 0;         // ticks since last change
+static uint8_t suspended = 0;               // 1 - no flash writes, state is kept pending
+
+static volatile uint16_t *rec_addr(uint8_t seg, uint8_t rec)
+{
+    return PERSIST_AREA + seg * SEG_WORDS + rec * REC_WORDS;
+}
+
+static uint16_t marker(const uint16_t *data)
+{
+    uint8_t i, sum = 0;
+
+    for (i = 0; i < DATA_WORDS; i++)
+        sum += (data[i] & 0xff) + (data[i] >> 8);
+
+    return (PERSIST_MAGIC << 8) | (uint8_t)~sum;
+}
+
+static uint8_t rec_used(volatile uint16_t *p)
+{
+    uint8_t i;
+
+    for (i = 0; i < REC_WORDS; i++)
+    {
+        if (p[i] != 0xffff)
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Copy record into data if it is valid
+ * @return 1 if record is valid
+ */
+static uint8_t rec_read(volatile uint16_t *p, uint16_t *data)
+{
+    uint8_t i;
+
+    for (i = 0; i < DATA_WORDS; i++)
+        data[i] = p[i];
+
+    return (p[DATA_WORDS] == marker(data));
+}
+
+/**
+ * @brief Number of used records at the start of a segment
+ */
+static uint8_t seg_used(uint8_t seg)
+{
+    uint8_t rec;
+
+    for (rec = 0; rec < SEG_RECS; rec++)
+    {
+        if (rec_used(rec_addr(seg, rec)) == 0)
+            break;
+    }
+    return rec;
+}
+
+static void seg_erase(uint8_t seg)
+{
+    uint16_t state = __get_interrupt_state();
+
+    __disable_interrupt();
+    FCTL3 = FWKEY;                  // clear LOCK
+    FCTL1 = FWKEY | ERASE;          // segment erase
+    *rec_addr(seg, 0) = 0;          // dummy write starts erase, CPU is held until done
+    FCTL1 = FWKEY;
+    FCTL3 = FWKEY | LOCK;
+    __set_interrupt_state(state);
+}
+
+static void rec_write(volatile uint16_t *p, const uint16_t *data)
+{
+    uint8_t i;
+    uint16_t state = __get_interrupt_state();
+
+    __disable_interrupt();
+    FCTL3 = FWKEY;                  // clear LOCK
+    FCTL1 = FWKEY | WRT;            // word write
+    for (i = 0; i < DATA_WORDS; i++)
+        p[i] = data[i];
+    p[DATA_WORDS] = marker(data);   // marker goes last
+    FCTL1 = FWKEY;
+    FCTL3 = FWKEY | LOCK;
+    __set_interrupt_state(state);
+}
+
+/**
+ * @brief Find the latest valid record among the first 'used' of a segment
+ * @return 1 if a valid record was copied into data
+ */
+static uint8_t seg_latest(uint8_t seg, uint8_t used, uint16_t *data)
+{
+    uint8_t rec;
+
+    for (rec = used; rec > 0; rec--)
+    {
+        if (rec_read(rec_addr(seg, rec - 1), data) != 0)
+            return 1;
+    }
+    return 0;
+}
+
+uint8_t persist_init(void *data)
+{
+    uint8_t seg, used;
+    uint8_t full = NO_SEG, partial = NO_SEG;
+    uint8_t i, found = 0;
+    uint16_t tmp[DATA_WORDS];
+    uint8_t *d = data;
+
+    // records are appended in order => segment is empty, partial or full
+    for (seg = 0; seg < SEG_COUNT; seg++)
+    {
+        used = seg_used(seg);
+        if (used == SEG_RECS)
+            full = seg;
+        else if (used != 0)
+        {
+            partial = seg;
+            next_rec = used;
+        }
+    }
+
+    // full and partial segment => reset happened between writing to the new
+    // segment and erasing the old one, partial segment holds the latest record
+    active = (partial != NO_SEG) ? partial : full;
+    if ((partial == NO_SEG) && (full != NO_SEG))
+        next_rec = SEG_RECS;
+
+    if (active != NO_SEG)
+        found = seg_latest(active, next_rec, tmp);
+
+    if ((partial != NO_SEG) && (full != NO_SEG))
+    {
+        if (found != 0)
+            seg_erase(full);        // old segment is no longer needed
+        else
+            found = seg_latest(full, SEG_RECS, tmp);    // first record of new segment was torn,
+                                                        // keep the old one until a valid record follows
+    }
+
+    for (i = 0; i < DATA_WORDS; i++)
+    {
+        written[i] = found ? tmp[i] : 0xffff;
+        pending[i] = written[i];
+        if (found)
+        {
+            d[2*i] = tmp[i] & 0xff;
+            d[2*i + 1] = tmp[i] >> 8;
+        }
+    }
+
+    return found;
+}
+
+void persist_store(const void *data)
+{
+    uint8_t i;
+    const uint8_t *d = data;
+
+    for (i = 0; i < DATA_WORDS; i++)
+        pending[i] = d[2*i] | (d[2*i + 1] << 8);
+    quiet = 0;
+    dirty = 1;
+}
+
+void persist_tick(void)
+{
+    if ((dirty != 0) && (quiet < PERSIST_DELAY))
+        quiet++;
+}
+
+uint8_t persist_pending(void)
+{
+    return (suspended == 0) && (dirty != 0) && (quiet >= PERSIST_DELAY);
+}
+
+void persist_suspend(uint8_t on)
+{
+    suspended = on;
+}
+
+uint8_t persist_service(void)
+{
+    uint8_t i, old = NO_SEG, same = 1, erased = 0;
+
+    if ((suspended != 0) || (dirty == 0) || (quiet < PERSIST_DELAY))
+        return 0;
+    dirty = 0;
+
+    for (i = 0; i < DATA_WORDS; i++)
+    {
+        if (pending[i] != written[i])
+            same = 0;
+    }
+    if (same != 0)
+        return 0;                   // state went back to what is already stored
+
+    if ((active == NO_SEG) || (next_rec == SEG_RECS))
+    {
+        // rotate: prepare next segment, old one is erased after the write
+        old = active;
+        active = (active == NO_SEG) ? 0 : (active + 1) % SEG_COUNT;
+        if (seg_used(active) != 0)
+        {
+            seg_erase(active);
+            erased = 1;
+        }
+        next_rec = 0;
+    }
+
+    rec_write(rec_addr(active, next_rec), pending);
+    next_rec++;
+
+    if (old != NO_SEG)
+    {
+        seg_erase(old);
+        erased = 1;
+    }
+
+    for (i = 0; i < DATA_WORDS; i++)
+        written[i] = pending[i];
+    return erased;
+}
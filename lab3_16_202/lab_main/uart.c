@@ -0,0 +1,390 @@
+/**
+ * @file uart.c
+ * @brief Buffered USCI_A1 UART driver with error accounting and flow control
+ *
+ * UCA1STAT is checked on every received byte, before UCA1RXBUF is read
+ * (reading UCA1RXBUF clears UCRXERR, UCFE, UCPE and UCOE).
+ * UCRXEIE is set so that bytes received with errors also raise UCRXIFG
+ * and can be counted instead of being silently dropped by USCI.
+ *
+ * @date 19.10.2026.
+ * @author  Andrea Ciric (andreaciric23@gmail.com)
+ *
+ * @version [1.0 - 10/2026] Initial version for MSP430F5529
+ *
+ */
+
+#include <msp430.h>
+#include <stdint.h>
+#include "uart.h"
+#include "irq.h"
+
+#define BR9600      (3)         //ACLK
+#define BRS9600      (UCBRS_3)  //ACLK
+
+#define RTS_PIN     (BIT0)      // P2.0 - RTS out, low means "PC may send"
+#define CTS_PIN     (BIT2)      // P2.2 - CTS in, low means "we may send"
+
+#define HOLD_CYCLES (2 * SMCLK_HZ / 960)    // two characters at 9600 bps, MCLK = SMCLK
+
+#define STAT_INC(x)     do { if ((x) != 0xffff) (x)++; } while (0)
+
+volatile uart_stats_t uart_stats;
+
+static volatile uint8_t rx_buf[UART_RX_SIZE];
+static volatile uint8_t rx_head = 0;        // written by ISR
+static volatile uint8_t rx_tail = 0;        // written by main
+static volatile uint8_t rx_throttled = 0;   // PC is currently throttled
+
+static volatile uint8_t tx_buf[UART_TX_SIZE];
+static volatile uint8_t tx_head = 0;        // written by main
+static volatile uint8_t tx_tail = 0;        // written by ISR
+static volatile uint8_t tx_busy = 0;        // a byte is being shifted out, TX ISR will follow
+static volatile uint8_t tx_ctrl = 0;        // XON/XOFF waiting to be sent ahead of data
+static volatile uint8_t tx_xoff = 0;        // PC sent XOFF
+
+/**
+ * @brief Check if PC allows us to send
+ */
+static uint8_t tx_allowed(void)
+{
+    if (uart_stats.flow == UART_FLOW_XONXOFF)
+        return (tx_xoff == 0);
+    if (uart_stats.flow == UART_FLOW_RTSCTS)
+        return ((P2IN & CTS_PIN) == 0);
+    return 1;
+}
+
+/**
+ * @brief Load next byte into UCA1TXBUF
+ *
+ * Must be called from ISR or with interrupts disabled.
+ * Control characters have precedence over queued data.
+ */
+static void tx_next(void)
+{
+    if (tx_ctrl != 0)
+    {
+        UCA1TXBUF = tx_ctrl;
+        tx_ctrl = 0;
+        tx_busy = 1;
+    }
+    else if ((tx_head != tx_tail) && tx_allowed())
+    {
+        UCA1TXBUF = tx_buf[tx_tail & (UART_TX_SIZE - 1)];
+        tx_tail++;
+        tx_busy = 1;
+    }
+    else
+    {
+        tx_busy = 0;                // next byte will be started by tx_kick
+    }
+}
+
+/**
+ * @brief Start transmitter if it is idle
+ */
+static void tx_kick(void)
+{
+    uint16_t state = __get_interrupt_state();
+
+    __disable_interrupt();
+    if (tx_busy == 0)
+        tx_next();
+    __set_interrupt_state(state);
+}
+
+/**
+ * @brief Ask PC to stop sending. Called from ISR.
+ */
+static void throttle(void)
+{
+    rx_throttled = 1;
+    STAT_INC(uart_stats.throttled);
+    if (uart_stats.flow == UART_FLOW_XONXOFF)
+    {
+        tx_ctrl = UART_XOFF;
+        if (tx_busy == 0)
+            tx_next();
+    }
+    else if (uart_stats.flow == UART_FLOW_RTSCTS)
+    {
+        P2OUT |= RTS_PIN;           // release RTS
+    }
+}
+
+/**
+ * @brief Let PC send again. Called with interrupts disabled.
+ */
+static void unthrottle(void)
+{
+    rx_throttled = 0;
+    if (uart_stats.flow == UART_FLOW_XONXOFF)
+    {
+        tx_ctrl = UART_XON;
+        if (tx_busy == 0)
+            tx_next();
+    }
+    else if (uart_stats.flow == UART_FLOW_RTSCTS)
+    {
+        P2OUT &= ~RTS_PIN;          // assert RTS
+    }
+}
+
+void uart_init(uint8_t flow)
+{
+    // Initialize UART
+    P4SEL |= BIT4 | BIT5;           // enable P4.4 and P4.5 for UART
+
+    // RTS/CTS pins, used only in UART_FLOW_RTSCTS mode
+    P2DIR |= RTS_PIN;               // RTS is out
+    P2OUT &= ~RTS_PIN;              // ready to receive
+    P2DIR &= ~CTS_PIN;              // CTS is in
+    P2REN |= CTS_PIN;               // enable pull up/down
+    P2OUT |= CTS_PIN;               // pull up => CTS not connected means "do not send"
+    P2IES |= CTS_PIN;               // interrupt on falling edge (CTS asserted)
+
+    UCA1CTL1 |= UCSWRST;            // set software reset
+
+    UCA1CTL0 = 0;                   // no parity, 8bit, 1 stop bit
+    UCA1CTL1 |= UCSSEL__ACLK;       // use ACLK = 32 768 Hz
+    UCA1CTL1 |= UCRXEIE;            // erroneous characters also set UCRXIFG
+    UCA1BRW = BR9600;               // BR = 3
+    UCA1MCTL |= BRS9600 + UCBRF_0;   // BRS = 3 for 9600 bps
+
+    UCA1CTL1 &= ~UCSWRST;           // release software reset
+
+    uart_clear_stats();
+    uart_set_flow(flow);
+
+    UCA1IE |= UCRXIE | UCTXIE;      // enable RX and TX interrupt
+}
+
+void uart_set_flow(uint8_t flow)
+{
+    uint16_t state = __get_interrupt_state();
+
+    __disable_interrupt();
+    if (rx_throttled != 0)
+        unthrottle();               // release PC using the old mode
+    uart_stats.flow = flow;
+    tx_xoff = 0;
+
+    P2IFG &= ~CTS_PIN;
+    if (flow == UART_FLOW_RTSCTS)
+        P2IE |= CTS_PIN;            // wake transmitter when CTS gets asserted
+    else
+        P2IE &= ~CTS_PIN;
+    __set_interrupt_state(state);
+
+    tx_kick();
+}
+
+int16_t uart_getc(void)
+{
+    uint8_t c;
+    uint16_t state;
+
+    if (rx_head == rx_tail)
+        return -1;
+
+    c = rx_buf[rx_tail & (UART_RX_SIZE - 1)];
+    rx_tail++;
+
+    if (rx_throttled != 0)
+    {
+        state = __get_interrupt_state();
+        __disable_interrupt();
+        if ((rx_throttled != 0) && ((uint8_t)(rx_head - rx_tail) <= UART_RX_LOW))
+            unthrottle();
+        __set_interrupt_state(state);
+    }
+
+    return c;
+}
+
+uint8_t uart_putc(uint8_t c)
+{
+    if ((uint8_t)(tx_head - tx_tail) >= UART_TX_SIZE)
+    {
+        STAT_INC(uart_stats.tx_dropped);
+        return 0;
+    }
+
+    tx_buf[tx_head & (UART_TX_SIZE - 1)] = c;
+    tx_head++;
+    tx_kick();
+
+    return 1;
+}
+
+uint8_t uart_tx_free(void)
+{
+    return UART_TX_SIZE - (uint8_t)(tx_head - tx_tail);
+}
+
+uint8_t uart_idle(void)
+{
+    return (rx_head == rx_tail) && (tx_head == tx_tail) && (tx_busy == 0)
+            && ((UCA1STAT & UCBUSY) == 0);
+}
+
+uint8_t uart_hold(void)
+{
+    if (uart_stats.flow != UART_FLOW_RTSCTS)
+        return 1;                   // PC can not be held off
+
+    P2OUT |= RTS_PIN;               // release RTS
+    __delay_cycles(HOLD_CYCLES);   // byte already started by PC is received by ISR
+    if (uart_idle() == 0)
+    {
+        uart_release();
+        return 0;
+    }
+    return 1;
+}
+
+void uart_release(void)
+{
+    uint16_t state = __get_interrupt_state();
+
+    __disable_interrupt();
+    if ((uart_stats.flow == UART_FLOW_RTSCTS) && (rx_throttled == 0))
+        P2OUT &= ~RTS_PIN;          // assert RTS
+    __set_interrupt_state(state);
+}
+
+uint8_t uart_read_stats(uint8_t *dst)
+{
+    uart_stats_t s;
+    uint16_t state = __get_interrupt_state();
+
+    __disable_interrupt();          // take consistent snapshot
+    s = uart_stats;
+    __set_interrupt_state(state);
+
+    dst[0] = s.rx_bytes; dst[1] = s.rx_bytes >> 8;
+    dst[2] = s.overrun; dst[3] = s.overrun >> 8;
+    dst[4] = s.framing; dst[5] = s.framing >> 8;
+    dst[6] = s.parity; dst[7] = s.parity >> 8;
+    dst[8] = s.brk; dst[9] = s.brk >> 8;
+    dst[10] = s.rx_dropped; dst[11] = s.rx_dropped >> 8;
+    dst[12] = s.tx_dropped; dst[13] = s.tx_dropped >> 8;
+    dst[14] = s.throttled; dst[15] = s.throttled >> 8;
+    dst[16] = s.rx_peak;
+    dst[17] = s.flow;
+
+    return UART_STATS_SIZE;
+}
+
+void uart_clear_stats(void)
+{
+    uint8_t flow = uart_stats.flow;
+    uint16_t state = __get_interrupt_state();
+
+    __disable_interrupt();
+    uart_stats.rx_bytes = 0;
+    uart_stats.overrun = 0;
+    uart_stats.framing = 0;
+    uart_stats.parity = 0;
+    uart_stats.brk = 0;
+    uart_stats.rx_dropped = 0;
+    uart_stats.tx_dropped = 0;
+    uart_stats.throttled = 0;
+    uart_stats.rx_peak = 0;
+    uart_stats.flow = flow;
+    __set_interrupt_state(state);
+}
+
+/**
+ * @brief USCI UART ISR
+ *
+ * On RX check error flags, handle XON/XOFF from PC and put byte into
+ * RX buffer. On TX send next queued byte.
+ */
+void __attribute__ ((interrupt(USCI_A1_VECTOR))) UARTISR (void)
+{
+    irq_ctx_t ctx;
+    uint8_t status, data, fill;
+
+    ctx.entry = irq_now();
+    irq_enter(&ctx, IRQ_SRC_UART);
+
+    switch (UCA1IV)
+    {
+    case 0:
+        break;
+    case USCI_UCRXIFG:                      // on Rx interrupt flag do:
+        status = UCA1STAT;                  // read before RXBUF, RXBUF read clears error flags
+        data = UCA1RXBUF;
+
+        if ((status & UCRXERR) != 0)
+        {
+            if ((status & UCOE) != 0)       // previous byte lost, this one is valid
+                STAT_INC(uart_stats.overrun);
+            if ((status & UCBRK) != 0)
+                STAT_INC(uart_stats.brk);
+            if ((status & UCPE) != 0)
+                STAT_INC(uart_stats.parity);
+            if ((status & UCFE) != 0)
+                STAT_INC(uart_stats.framing);
+            if ((status & (UCFE | UCPE | UCBRK)) != 0)
+                break;                      // data is corrupted, discard it
+        }
+
+        if (uart_stats.flow == UART_FLOW_XONXOFF)
+        {
+            if (data == UART_XOFF)
+            {
+                tx_xoff = 1;
+                break;
+            }
+            if (data == UART_XON)
+            {
+                tx_xoff = 0;
+                if (tx_busy == 0)
+                    tx_next();
+                break;
+            }
+        }
+
+        fill = rx_head - rx_tail;
+        if (fill >= UART_RX_SIZE)
+        {
+            STAT_INC(uart_stats.rx_dropped);
+            break;
+        }
+        rx_buf[rx_head & (UART_RX_SIZE - 1)] = data;
+        rx_head++;
+        fill++;
+        STAT_INC(uart_stats.rx_bytes);
+
+        if (fill > uart_stats.rx_peak)
+            uart_stats.rx_peak = fill;
+        if ((fill >= UART_RX_HIGH) && (rx_throttled == 0))
+            throttle();
+        break;
+    case USCI_UCTXIFG:                      // on Tx interrupt flag do:
+        /* UCTXIFG is reset by reading UCA1IV, so the next byte
+           must be written here or transmitter goes idle */
+        tx_next();
+        break;
+    }
+
+    irq_exit(&ctx);
+}
+
+/**
+ * @brief PORT2 ISR
+ *
+ * CTS got asserted, resume sending.
+ */
+void __attribute__ ((interrupt(PORT2_VECTOR))) P2ISR (void)
+{
+    if ((P2IFG & CTS_PIN) != 0)
+    {
+        P2IFG &= ~CTS_PIN;
+        if (tx_busy == 0)
+            tx_next();
+    }
+}
@@ -0,0 +1,143 @@
+/**
+ * @file uart.h
+ * @brief Declarations for the buffered USCI_A1 UART driver
+ *
+ * Received bytes are placed into a ring buffer by the ISR and read
+ * from main with uart_getc(). Bytes to be sent are queued with
+ * uart_putc() and sent from the TX interrupt, so neither side blocks.
+ * RX errors (overrun, framing, parity, break) and bytes dropped
+ * because of a full buffer are counted in uart_stats.
+ *
+ * @date 19.10.2026.
+ * @author  Andrea Ciric (andreaciric23@gmail.com)
+ *
+ * @version [1.0 - 10/2026] Initial version for MSP430F5529
+ *
+ */
+
+#ifndef UART_H_
+#define UART_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Flow control modes
+ *
+ * In XON/XOFF mode XOFF (0x13) is sent when RX buffer fills up to
+ * UART_RX_HIGH and XON (0x11) when it drains to UART_RX_LOW.
+ * XON/XOFF received from PC pauses/resumes our transmitter.
+ *
+ * In RTS/CTS mode RTS (P2.0, out, active low) is released on UART_RX_HIGH
+ * and asserted again on UART_RX_LOW. Transmitter sends only while
+ * CTS (P2.2, in, active low) is asserted by the PC.
+ *
+ * Code that holds interrupts off longer than one character time (flash
+ * erase) holds the PC off first with uart_hold(). That works only in
+ * RTS/CTS mode; without flow control bytes sent by the PC in that
+ * time are lost (counted as overrun).
+ */
+#define UART_FLOW_NONE      (0)
+#define UART_FLOW_XONXOFF   (1)
+#define UART_FLOW_RTSCTS    (2)
+
+#define UART_XON            (0x11)
+#define UART_XOFF           (0x13)
+
+#define UART_RX_SIZE        (32)    // must be power of 2
+#define UART_TX_SIZE        (32)    // must be power of 2
+#define UART_RX_HIGH        (24)    // throttle PC when this many bytes are waiting
+#define UART_RX_LOW         (8)     // release PC when buffer drains to this level
+
+/**
+ * @brief UART statistics block
+ *
+ * All counters saturate at 0xffff.
+ */
+typedef struct
+{
+    uint16_t rx_bytes;      // bytes placed into RX buffer
+    uint16_t overrun;       // UCOE - previous byte was overwritten in UCA1RXBUF
+    uint16_t framing;       // UCFE - byte discarded
+    uint16_t parity;        // UCPE - byte discarded
+    uint16_t brk;           // UCBRK - break condition detected
+    uint16_t rx_dropped;    // RX buffer full, byte discarded
+    uint16_t tx_dropped;    // TX buffer full, byte not queued
+    uint16_t throttled;     // number of times PC was throttled
+    uint8_t rx_peak;        // highest RX buffer fill level seen
+    uint8_t flow;           // current flow control mode
+} uart_stats_t;
+
+extern volatile uart_stats_t uart_stats;
+
+#define UART_STATS_SIZE     (18)    // bytes written by uart_read_stats()
+
+/**
+ * @brief Initialize USCI_A1 in UART mode, 9600 bps on ACLK
+ * @param flow - flow control mode (UART_FLOW_x)
+ */
+extern void uart_init(uint8_t flow);
+
+/**
+ * @brief Change flow control mode on the run
+ * @param flow - flow control mode (UART_FLOW_x)
+ */
+extern void uart_set_flow(uint8_t flow);
+
+/**
+ * @brief Take one byte from RX buffer
+ * @return received byte or -1 if buffer is empty
+ */
+extern int16_t uart_getc(void);
+
+/**
+ * @brief Queue one byte for sending
+ * @param c - byte to be sent
+ * @return 1 if byte was queued, 0 if TX buffer is full
+ */
+extern uint8_t uart_putc(uint8_t c);
+
+/**
+ * @brief Free space in TX buffer
+ * @return number of bytes that can be queued without dropping
+ */
+extern uint8_t uart_tx_free(void);
+
+/**
+ * @brief Check if nothing is being received or sent
+ * @return 1 if both buffers are empty and USCI is not busy
+ */
+extern uint8_t uart_idle(void);
+
+/**
+ * @brief Hold the PC off before interrupts are disabled for a long time
+ * @return 1 if line is quiet and code may go on, 0 if a byte came in
+ *         while waiting, nothing is held then
+ *
+ * In RTS/CTS mode RTS is released and a byte the PC has already started
+ * is waited for (two character times, busy wait). In other modes the PC can
+ * not be held off and 1 is returned right away. Has to be followed by
+ * uart_release() when 1 is returned.
+ */
+extern uint8_t uart_hold(void);
+
+/**
+ * @brief Let the PC send again after uart_hold()
+ */
+extern void uart_release(void);
+
+/**
+ * @brief Take a consistent snapshot of stats block
+ * @param dst - UART_STATS_SIZE bytes
+ * @return number of bytes written
+ *
+ * Counters are written as 16bit little endian values in the order of
+ * uart_stats_t, followed by rx_peak and flow bytes.
+ */
+extern uint8_t uart_read_stats(uint8_t *dst);
+
+/**
+ * @brief Clear all stats counters
+ */
+extern void uart_clear_stats(void);
+
+#endif /* UART_H_ */